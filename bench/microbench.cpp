@@ -0,0 +1,200 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Microbenchmarks for the engine's hot primitives, built and run with `make microbench`.
+// Each benchmark is warmed up once and then timed over several repetitions; the fastest and median
+// repetitions are reported in nanoseconds per operation, which keeps scheduler noise out of the comparison
+// between builds (e.g. different BUILD= architecture levels).
+
+#include "../src/attackmap.h"
+#include "../src/attacks.h"
+#include "../src/bench.h"
+#include "../src/cuckoo.h"
+#include "../src/eval.h"
+#include "../src/movegen.h"
+#include "../src/nnue.h"
+#include "../src/position.h"
+#include "../src/types.h"
+#include "../src/utils/prng.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace purebred;
+
+namespace {
+    constexpr usize kRepetitions = 7;
+    constexpr usize kOccupancies = 4096;
+
+    // Results are folded into this so that the compiler cannot discard the work being timed
+    volatile u64 sink = 0;
+
+    struct Sample {
+        Square sq;
+        Bitboard occ;
+    };
+
+    // Times `iterations` calls of `op`, each of which performs `opsPerIteration` operations.
+    template <typename Op>
+    void measure(const char *name, usize iterations, usize opsPerIteration, Op op) {
+        std::vector<f64> times;
+        u64 acc = 0;
+
+        for (usize rep = 0; rep <= kRepetitions; ++rep) {
+            const auto start = std::chrono::steady_clock::now();
+            for (usize i = 0; i < iterations; ++i) acc += op();
+            const auto end = std::chrono::steady_clock::now();
+
+            // The first repetition only warms up the caches and branch predictors
+            if (rep == 0) continue;
+
+            const f64 ns = static_cast<f64>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            times.push_back(ns / static_cast<f64>(iterations * opsPerIteration));
+        }
+
+        sink = sink + acc;
+        std::sort(times.begin(), times.end());
+        std::printf("%-24s %10.2f ns/op (best) %10.2f ns/op (median)\n", name, times.front(), times[times.size() / 2]);
+    }
+}
+
+i32 main(i32 argc, char *argv[]) {
+    attacks::init();
+    cuckoo::init();
+
+    utils::PRNG prng{U64C(0x5EED5EED5EED5EED)};
+    std::vector<Sample> samples;
+    for (usize i = 0; i < kOccupancies; ++i)
+        samples.push_back({Square{static_cast<u8>(prng.next_bounded(64))}, Bitboard{prng.next_sparse()}});
+
+    std::vector<Position> positions;
+    for (std::string_view fen : bench::kFens) {
+        if (const auto pos = Position::from_fen(fen)) positions.push_back(*pos);
+    }
+
+    std::vector<MoveList> legalMoves(positions.size());
+    usize totalMoves = 0;
+    for (usize i = 0; i < positions.size(); ++i) {
+        movegen::generate_legal(positions[i], legalMoves[i]);
+        totalMoves += legalMoves[i].size();
+    }
+
+    measure("bishop attacks", 1000, samples.size(), [&]() {
+        u64 acc = 0;
+        for (const Sample &s : samples) acc ^= attacks::get_bishop_attacks(s.sq, s.occ).raw();
+        return acc;
+    });
+
+    measure("rook attacks", 1000, samples.size(), [&]() {
+        u64 acc = 0;
+        for (const Sample &s : samples) acc ^= attacks::get_rook_attacks(s.sq, s.occ).raw();
+        return acc;
+    });
+
+    measure("queen attacks", 1000, samples.size(), [&]() {
+        u64 acc = 0;
+        for (const Sample &s : samples) acc ^= attacks::get_queen_attacks(s.sq, s.occ).raw();
+        return acc;
+    });
+
+    measure("attack maps", 50000, positions.size(), [&]() {
+        u64 acc = 0;
+        for (const Position &pos : positions) acc ^= attacks::attack_map(pos, pos.stm()).all.raw();
+        return acc;
+    });
+
+    measure("pseudo-legal movegen", 20000, positions.size(), [&]() {
+        u64 acc = 0;
+        for (const Position &pos : positions) {
+            MoveList moves;
+            movegen::generate<movegen::GenType::kAll>(pos, moves);
+            acc += moves.size();
+        }
+        return acc;
+    });
+
+    measure("legal movegen", 20000, positions.size(), [&]() {
+        u64 acc = 0;
+        for (const Position &pos : positions) {
+            MoveList moves;
+            movegen::generate_legal(pos, moves);
+            acc += moves.size();
+        }
+        return acc;
+    });
+
+    measure("checking movegen", 20000, positions.size(), [&]() {
+        for (const Position &pos : positions) {
+            MoveList moves;
+            movegen::generate<movegen::GenType::kChecks>(pos, moves);
+
+            // Check generation is inlined whole here, and without a volatile write per position the compiler hoists
+            // it out of the timing loop
+            sink = sink + moves.size();
+        }
+        return u64{0};
+    });
+
+    measure("make/unmake", 2000, totalMoves, [&]() {
+        u64 acc = 0;
+        for (usize i = 0; i < positions.size(); ++i) {
+            for (Move move : legalMoves[i]) {
+                positions[i].make_move(move);
+                acc ^= positions[i].key();
+                positions[i].unmake_move();
+            }
+        }
+        return acc;
+    });
+
+    measure("full key computation", 50000, positions.size(), [&]() {
+        u64 acc = 0;
+        for (const Position &pos : positions) acc ^= pos.compute_key();
+        return acc;
+    });
+
+    measure("evaluation", 50000, positions.size(), [&]() {
+        u64 acc = 0;
+        for (const Position &pos : positions) acc += static_cast<u64>(eval::evaluate(pos));
+        return acc;
+    });
+
+    // The network benchmarks need a network file, given as `make microbench NET=<file>`
+    if (argc > 1 && nnue::load(argv[1])) {
+        std::vector<nnue::Accumulator> accumulators(positions.size());
+
+        measure("network refresh", 20000, positions.size(), [&]() {
+            for (usize i = 0; i < positions.size(); ++i) nnue::refresh(accumulators[i], positions[i]);
+            return static_cast<u64>(accumulators[0].values[0][0]);
+        });
+
+        measure("network forward", 200000, positions.size(), [&]() {
+            u64 acc = 0;
+            for (usize i = 0; i < positions.size(); ++i) {
+                acc += static_cast<u64>(nnue::forward(accumulators[i], positions[i].stm(), nnue::output_bucket(positions[i])));
+            }
+            return acc;
+        });
+    }
+
+    return sink == 0xDEADBEEF;
+}
@@ -0,0 +1,243 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "analyse.h"
+
+#include "position.h"
+#include "search.h"
+#include "tt.h"
+#include "utils/parse.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace purebred::analyse {
+
+    namespace {
+        struct Options {
+            std::string input;
+            std::string output;
+            search::Limits limits;
+            usize threads = 1;
+            usize hash = TranspositionTable::kDefaultSizeMB;
+        };
+
+        // Hands out input lines to workers one at a time, numbering them so that output order can be restored.
+        class LineReader {
+        public:
+            explicit LineReader(std::istream &in) : mIn(in) {}
+
+            [[nodiscard]] bool next(u64 &index, std::string &line) {
+                std::lock_guard lock{mMutex};
+                if (!std::getline(mIn, line)) return false;
+                index = mNext++;
+                return true;
+            }
+
+        private:
+            std::istream &mIn;
+            std::mutex mMutex;
+            u64 mNext = 0;
+        };
+
+        // Buffers results which complete out of order, and writes each one as soon as all earlier ones are written.
+        class OrderedWriter {
+        public:
+            explicit OrderedWriter(std::ostream &out) : mOut(out) {}
+
+            void submit(u64 index, std::string result) {
+                std::lock_guard lock{mMutex};
+                mPending.emplace(index, std::move(result));
+
+                bool wrote = false;
+                for (auto it = mPending.begin(); it != mPending.end() && it->first == mNext; it = mPending.erase(it)) {
+                    if (!it->second.empty()) mOut << it->second << '\n';
+                    mNext++;
+                    wrote = true;
+                }
+
+                if (wrote) mOut.flush();
+            }
+
+        private:
+            std::ostream &mOut;
+            std::mutex mMutex;
+            std::map<u64, std::string> mPending;
+            u64 mNext = 0;
+        };
+
+        std::string format_result(const std::string &line, const search::SearchResult &result, bool chess960) {
+            std::string out = line + " ; bestmove " + (result.bestMove != Moves::kNone ? result.bestMove.to_str(chess960) : "0000");
+
+            if (result.score >= Scores::kMateInMaxPly)
+                out += " ; score mate " + std::to_string((Scores::kMate - result.score + 1) / 2);
+            else if (result.score <= -Scores::kMateInMaxPly)
+                out += " ; score mate " + std::to_string(-(Scores::kMate + result.score) / 2);
+            else
+                out += " ; score cp " + std::to_string(result.score);
+
+            out += " ; depth " + std::to_string(result.depth) + " ; nodes " + std::to_string(result.nodes);
+            return out;
+        }
+
+        bool parse_options(i32 argc, char *argv[], Options &options) {
+            bool limited = false;
+
+            for (i32 i = 2; i < argc; ++i) {
+                const std::string_view flag = argv[i];
+                if (i + 1 >= argc) {
+                    std::cerr << "Missing value for " << flag << std::endl;
+                    return false;
+                }
+
+                const std::string_view value = argv[++i];
+                bool ok = true;
+
+                if (flag == "--input") options.input = value;
+                else if (flag == "--output") options.output = value;
+                else if (flag == "--depth") {
+                    const auto depth = utils::parse_int<i32>(value);
+                    ok = depth && *depth > 0;
+                    if (ok) options.limits.depth = *depth;
+                } else if (flag == "--nodes") {
+                    const auto nodes = utils::parse_int<u64>(value);
+                    // A node limit of 0 means no limit, which would leave the search unlimited
+                    ok = nodes && *nodes > 0;
+                    if (ok) options.limits.nodes = *nodes;
+                } else if (flag == "--movetime") {
+                    const auto movetime = utils::parse_int<i64>(value);
+                    ok = movetime && *movetime > 0;
+                    if (ok) options.limits.movetime = *movetime;
+                } else if (flag == "--threads") {
+                    const auto threads = utils::parse_int<usize>(value);
+                    ok = threads && *threads > 0;
+                    if (ok) options.threads = *threads;
+                } else if (flag == "--hash") {
+                    const auto hash = utils::parse_int<usize>(value);
+                    ok = hash && *hash > 0;
+                    if (ok) options.hash = *hash;
+                } else if (flag == "--chess960") {
+                    ok = value == "true" || value == "false";
+                    options.limits.chess960 = value == "true";
+                } else {
+                    std::cerr << "Unknown option " << flag << std::endl;
+                    return false;
+                }
+
+                if (!ok) {
+                    std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+                    return false;
+                }
+
+                limited |= flag == "--depth" || flag == "--nodes" || flag == "--movetime";
+            }
+
+            if (options.input.empty()) {
+                std::cerr << "Usage: " << argv[0] << " analyse --input <file> [--output <file>] [--depth N] [--nodes N]"
+                          << " [--movetime ms] [--threads T] [--hash MB] [--chess960 true|false]" << std::endl;
+                return false;
+            }
+
+            if (!limited) options.limits.depth = 10;
+            return true;
+        }
+    }
+
+    i32 run(i32 argc, char *argv[]) {
+        Options options;
+        if (!parse_options(argc, argv, options)) return 1;
+
+        std::ifstream inFile;
+        if (options.input != "-") {
+            inFile.open(options.input);
+            if (!inFile) {
+                std::cerr << "Could not open " << options.input << std::endl;
+                return 1;
+            }
+        }
+
+        std::ofstream outFile;
+        if (!options.output.empty()) {
+            outFile.open(options.output);
+            if (!outFile) {
+                std::cerr << "Could not open " << options.output << std::endl;
+                return 1;
+            }
+        }
+
+        LineReader reader{options.input != "-" ? static_cast<std::istream &>(inFile) : std::cin};
+        OrderedWriter writer{!options.output.empty() ? static_cast<std::ostream &>(outFile) : std::cout};
+
+        // The table is never cleared between positions, so consecutive positions from the same game
+        // (which are handed out close together) can reuse each other's work.
+        TranspositionTable tt;
+        tt.resize(options.hash);
+
+        std::atomic<u64> positions = 0, totalNodes = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (usize i = 0; i < options.threads; ++i) {
+            threads.emplace_back([&]() {
+                std::atomic<bool> stop = false;
+                auto worker = std::make_unique<search::Worker>(tt, stop);
+                worker->clear();
+
+                u64 index;
+                std::string line;
+                while (reader.next(index, line)) {
+                    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) line.pop_back();
+
+                    if (line.empty() || line[0] == '#') {
+                        writer.submit(index, "");
+                        continue;
+                    }
+
+                    const auto pos = Position::from_fen(line);
+                    if (!pos) {
+                        writer.submit(index, line + " ; error invalid position");
+                        continue;
+                    }
+
+                    stop.store(false, std::memory_order_relaxed);
+                    const search::SearchResult result = worker->run(*pos, options.limits, search::Worker::Role::kSilent);
+
+                    positions.fetch_add(1, std::memory_order_relaxed);
+                    totalNodes.fetch_add(result.nodes, std::memory_order_relaxed);
+                    writer.submit(index, format_result(line, result, options.limits.chess960));
+                }
+            });
+        }
+
+        for (auto &thread : threads) thread.join();
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Analysed " << positions << " positions, " << totalNodes << " nodes in " << elapsed << " ms ("
+                  << totalNodes * 1000 / static_cast<u64>(std::max<i64>(elapsed, 1)) << " nps)" << std::endl;
+
+        return 0;
+    }
+}
@@ -0,0 +1,33 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "types.h"
+
+// Batch analysis: `Purebred analyse --input <file> [--output <file>] [--depth N] [--nodes N] [--movetime ms]
+//                                   [--threads T] [--hash MB] [--chess960 true|false]`
+// Positions (FEN or EPD, one per line) are streamed from the input and searched by independent workers,
+// each with its own search state but sharing one transposition table. Results are written in input order
+// as soon as they are available.
+namespace purebred::analyse {
+
+    // Returns the process exit code.
+    [[nodiscard]] i32 run(i32 argc, char *argv[]);
+}
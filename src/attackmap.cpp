@@ -0,0 +1,205 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "attackmap.h"
+
+#include <bit>
+
+#if defined(USE_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace purebred::attacks {
+
+    namespace {
+        // Sliding directions, orthogonal first. A negative shift is a rotation the other way.
+        constexpr utils::MDArray<i32, 8> kShifts = {8, -8, 1, -1, 9, 7, -7, -9};
+
+        // The squares a single step in each direction can land on; this also discards bits which wrapped around.
+        constexpr utils::MDArray<u64, 8> kLandingMasks = {
+            ~Bitboards::kRank1.raw(),
+            ~Bitboards::kRank8.raw(),
+            ~Bitboards::kFileA.raw(),
+            ~Bitboards::kFileH.raw(),
+            ~(Bitboards::kRank1 | Bitboards::kFileA).raw(),
+            ~(Bitboards::kRank1 | Bitboards::kFileH).raw(),
+            ~(Bitboards::kRank8 | Bitboards::kFileA).raw(),
+            ~(Bitboards::kRank8 | Bitboards::kFileH).raw()
+        };
+
+        // Kogge-Stone fills step 1, 2 and 4 squares at a time; these are those steps as left rotations.
+        constexpr auto kRotations = [](i32 factor) {
+            utils::MDArray<u64, 8> rotations{};
+            for (usize i = 0; i < 8; ++i) rotations[i] = static_cast<u64>(kShifts[i] * factor & 63);
+            return rotations;
+        };
+
+        constexpr utils::MDArray<u64, 8> kRotate1 = kRotations(1);
+        constexpr utils::MDArray<u64, 8> kRotate2 = kRotations(2);
+        constexpr utils::MDArray<u64, 8> kRotate4 = kRotations(4);
+
+        struct SliderMaps {
+            Bitboard bishop;
+            Bitboard rook;
+            Bitboard queen;
+        };
+
+        [[nodiscard]] constexpr Bitboard pawn_map(Colour c, Bitboard pawns) {
+            return c == Colours::kWhite ? pawns.shift<Direction::kUpLeft>() | pawns.shift<Direction::kUpRight>()
+                                        : pawns.shift<Direction::kDownLeft>() | pawns.shift<Direction::kDownRight>();
+        }
+
+        [[nodiscard]] constexpr Bitboard knight_map(Bitboard knights) {
+            const u64 bb = knights.raw();
+            const u64 l1 = (bb >> 1) & ~Bitboards::kFileH.raw();
+            const u64 l2 = (bb >> 2) & ~(Bitboards::kFileG | Bitboards::kFileH).raw();
+            const u64 r1 = (bb << 1) & ~Bitboards::kFileA.raw();
+            const u64 r2 = (bb << 2) & ~(Bitboards::kFileA | Bitboards::kFileB).raw();
+            const u64 h1 = l1 | r1;
+            const u64 h2 = l2 | r2;
+            return Bitboard{(h1 << 16) | (h1 >> 16) | (h2 << 8) | (h2 >> 8)};
+        }
+
+        [[nodiscard]] constexpr Bitboard king_map(Bitboard king) {
+            const Bitboard row = king | king.shift<Direction::kLeft>() | king.shift<Direction::kRight>();
+            return (row | row.shift<Direction::kUp>() | row.shift<Direction::kDown>()) ^ king;
+        }
+
+#if defined(USE_AVX512)
+        // All eight directions at once: rooks in the orthogonal lanes and bishops in the diagonal lanes,
+        // then a second fill with queens in every lane.
+        // The zero-masking form is used because the unmasked intrinsic trips -Wuninitialized in some GCC versions
+        [[nodiscard]] __m512i rotl8(__m512i x, __m512i amounts) {
+            return _mm512_maskz_rolv_epi64(0xFF, x, amounts);
+        }
+
+        [[nodiscard]] __m512i fill8(__m512i gen, __m512i empty, __m512i rot1, __m512i rot2, __m512i rot4, __m512i mask) {
+            __m512i pro = _mm512_and_si512(empty, mask);
+            gen = _mm512_or_si512(gen, _mm512_and_si512(pro, rotl8(gen, rot1)));
+            pro = _mm512_and_si512(pro, rotl8(pro, rot1));
+            gen = _mm512_or_si512(gen, _mm512_and_si512(pro, rotl8(gen, rot2)));
+            pro = _mm512_and_si512(pro, rotl8(pro, rot2));
+            gen = _mm512_or_si512(gen, _mm512_and_si512(pro, rotl8(gen, rot4)));
+            return _mm512_and_si512(mask, rotl8(gen, rot1));
+        }
+
+        [[nodiscard]] SliderMaps slider_maps(Bitboard bishops, Bitboard rooks, Bitboard queens, Bitboard occ) {
+            const __m512i r1 = _mm512_loadu_si512(kRotate1.data());
+            const __m512i r2 = _mm512_loadu_si512(kRotate2.data());
+            const __m512i r4 = _mm512_loadu_si512(kRotate4.data());
+            const __m512i mask = _mm512_loadu_si512(kLandingMasks.data());
+            const __m512i empty = _mm512_set1_epi64(static_cast<i64>(~occ.raw()));
+
+            const __m512i rb = _mm512_set_epi64(static_cast<i64>(bishops.raw()), static_cast<i64>(bishops.raw()),
+                                                static_cast<i64>(bishops.raw()), static_cast<i64>(bishops.raw()),
+                                                static_cast<i64>(rooks.raw()), static_cast<i64>(rooks.raw()),
+                                                static_cast<i64>(rooks.raw()), static_cast<i64>(rooks.raw()));
+            const __m512i q = _mm512_set1_epi64(static_cast<i64>(queens.raw()));
+
+            utils::MDArray<u64, 8> rbOut, qOut;
+            _mm512_storeu_si512(rbOut.data(), fill8(rb, empty, r1, r2, r4, mask));
+            _mm512_storeu_si512(qOut.data(), fill8(q, empty, r1, r2, r4, mask));
+
+            return {
+                Bitboard{rbOut[4] | rbOut[5] | rbOut[6] | rbOut[7]},
+                Bitboard{rbOut[0] | rbOut[1] | rbOut[2] | rbOut[3]},
+                Bitboard{qOut[0] | qOut[1] | qOut[2] | qOut[3] | qOut[4] | qOut[5] | qOut[6] | qOut[7]}
+            };
+        }
+#elif defined(USE_AVX2)
+        // AVX2 has no variable rotate, so it is built from a pair of variable shifts.
+        [[nodiscard]] __m256i rotl4(__m256i x, __m256i left) {
+            const __m256i right = _mm256_sub_epi64(_mm256_set1_epi64x(64), left);
+            return _mm256_or_si256(_mm256_sllv_epi64(x, left), _mm256_srlv_epi64(x, right));
+        }
+
+        // Four directions at once: either the orthogonal or the diagonal half of kShifts.
+        [[nodiscard]] __m256i fill4(__m256i gen, __m256i empty, usize half) {
+            const auto load = [half](const utils::MDArray<u64, 8> &arr) {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(arr.data() + half * 4));
+            };
+
+            const __m256i mask = load(kLandingMasks);
+            const __m256i r1 = load(kRotate1), r2 = load(kRotate2), r4 = load(kRotate4);
+
+            __m256i pro = _mm256_and_si256(empty, mask);
+            gen = _mm256_or_si256(gen, _mm256_and_si256(pro, rotl4(gen, r1)));
+            pro = _mm256_and_si256(pro, rotl4(pro, r1));
+            gen = _mm256_or_si256(gen, _mm256_and_si256(pro, rotl4(gen, r2)));
+            pro = _mm256_and_si256(pro, rotl4(pro, r2));
+            gen = _mm256_or_si256(gen, _mm256_and_si256(pro, rotl4(gen, r4)));
+            return _mm256_and_si256(mask, rotl4(gen, r1));
+        }
+
+        [[nodiscard]] u64 reduce_or(__m256i x) {
+            utils::MDArray<u64, 4> lanes;
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes.data()), x);
+            return lanes[0] | lanes[1] | lanes[2] | lanes[3];
+        }
+
+        [[nodiscard]] SliderMaps slider_maps(Bitboard bishops, Bitboard rooks, Bitboard queens, Bitboard occ) {
+            const __m256i empty = _mm256_set1_epi64x(static_cast<i64>(~occ.raw()));
+            const __m256i q = _mm256_set1_epi64x(static_cast<i64>(queens.raw()));
+
+            return {
+                Bitboard{reduce_or(fill4(_mm256_set1_epi64x(static_cast<i64>(bishops.raw())), empty, 1))},
+                Bitboard{reduce_or(fill4(_mm256_set1_epi64x(static_cast<i64>(rooks.raw())), empty, 0))},
+                Bitboard{reduce_or(_mm256_or_si256(fill4(q, empty, 0), fill4(q, empty, 1)))}
+            };
+        }
+#else
+        [[nodiscard]] constexpr u64 fill(u64 gen, u64 empty, usize dir) {
+            const i32 shift = kShifts[dir];
+            u64 pro = empty & kLandingMasks[dir];
+            gen |= pro & std::rotl(gen, shift);
+            pro &= std::rotl(pro, shift);
+            gen |= pro & std::rotl(gen, shift * 2);
+            pro &= std::rotl(pro, shift * 2);
+            gen |= pro & std::rotl(gen, shift * 4);
+            return kLandingMasks[dir] & std::rotl(gen, shift);
+        }
+
+        [[nodiscard]] constexpr SliderMaps slider_maps(Bitboard bishops, Bitboard rooks, Bitboard queens, Bitboard occ) {
+            SliderMaps maps{};
+            for (usize dir = 0; dir < 8; ++dir) {
+                const Bitboard own = dir < 4 ? rooks : bishops;
+                (dir < 4 ? maps.rook : maps.bishop) |= fill(own.raw(), ~occ.raw(), dir);
+                maps.queen |= fill(queens.raw(), ~occ.raw(), dir);
+            }
+            return maps;
+        }
+#endif
+    }
+
+    AttackMap attack_map(const Position &pos, Colour c) {
+        AttackMap map{};
+        const SliderMaps sliders = slider_maps(pos.pieces(c, PieceTypes::kBishop), pos.pieces(c, PieceTypes::kRook),
+                                               pos.pieces(c, PieceTypes::kQueen), pos.pieces());
+
+        map.byType[PieceTypes::kPawn] = pawn_map(c, pos.pieces(c, PieceTypes::kPawn));
+        map.byType[PieceTypes::kKnight] = knight_map(pos.pieces(c, PieceTypes::kKnight));
+        map.byType[PieceTypes::kBishop] = sliders.bishop;
+        map.byType[PieceTypes::kRook] = sliders.rook;
+        map.byType[PieceTypes::kQueen] = sliders.queen;
+        map.byType[PieceTypes::kKing] = king_map(pos.pieces(c, PieceTypes::kKing));
+
+        for (Bitboard bb : map.byType) map.all |= bb;
+        return map;
+    }
+}
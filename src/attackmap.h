@@ -0,0 +1,40 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "bitboard.h"
+#include "position.h"
+#include "types.h"
+#include "utils/mdarray.h"
+
+// Whole-board attack maps: every square attacked by each piece type of one colour, computed in a single pass
+// from the piece sets rather than square by square. Leapers are done with bitboard shifts and sliders with
+// Kogge-Stone occluded fills, which are vectorised across directions in AVX2/AVX-512 builds.
+namespace purebred::attacks {
+
+    struct AttackMap {
+        utils::MDArray<Bitboard, PieceType::kNumTypes> byType;
+        Bitboard all;
+
+        [[nodiscard]] bool operator==(const AttackMap &) const = default;
+    };
+
+    [[nodiscard]] AttackMap attack_map(const Position &pos, Colour c);
+}
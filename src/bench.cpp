@@ -0,0 +1,94 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+
+#include "position.h"
+#include "search.h"
+#include "tt.h"
+#include "utils/parse.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace purebred::bench {
+
+    void run(i32 depth, usize threads) {
+        TranspositionTable tt;
+        search::ThreadPool pool{tt};
+        pool.set_deterministic(true);
+        pool.set_threads(threads);
+
+        search::Limits limits;
+        limits.depth = depth;
+
+        u64 totalNodes = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (usize i = 0; i < kFens.size(); ++i) {
+            const auto pos = Position::from_fen(kFens[i]);
+            if (!pos) continue;
+
+            // Every position is searched from a clean state so that the node count is reproducible
+            tt.clear();
+            pool.clear();
+
+            const search::SearchResult result = pool.search(*pos, limits);
+            totalNodes += result.nodes;
+
+            std::cout << "Position " << i + 1 << "/" << kFens.size() << ": " << result.nodes << " nodes, bestmove "
+                      << result.bestMove.to_str<false>() << std::endl;
+        }
+
+        const i64 elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+        if constexpr (stats::kEnabled) pool.stats().print(std::cout);
+
+        std::cout << totalNodes << " nodes " << totalNodes * 1000 / static_cast<u64>(std::max<i64>(elapsed, 1)) << " nps" << std::endl;
+    }
+
+    i32 run(i32 argc, char *argv[]) {
+        i32 depth = kDefaultDepth;
+        usize threads = 1;
+
+        if (argc > 2) {
+            const auto parsed = utils::parse_int<i32>(argv[2]);
+            if (!parsed || *parsed < 1 || *parsed > search::kMaxDepth) {
+                std::cerr << "Invalid bench depth: " << argv[2] << std::endl;
+                return 1;
+            }
+            depth = *parsed;
+        }
+
+        if (argc > 3) {
+            const auto parsed = utils::parse_int<usize>(argv[3]);
+            if (!parsed || *parsed < 1 || *parsed > search::kMaxThreads) {
+                std::cerr << "Invalid bench thread count: " << argv[3] << std::endl;
+                return 1;
+            }
+            threads = *parsed;
+        }
+
+        run(depth, threads);
+        return 0;
+    }
+}
@@ -113,7 +113,7 @@ namespace purebred {
             return *this = *this >> shift;
         }
 
-        [[nodiscard]] constexpr bool get_bit(Square sq) {
+        [[nodiscard]] constexpr bool get_bit(Square sq) const {
             return mData & Bitboard{sq};
         }
 
@@ -169,12 +169,12 @@ namespace purebred {
         template <Direction kDir>
         [[nodiscard]] constexpr Bitboard ray(Bitboard occ = Bitboard{}) const;
 
-    private:
-        u64 mData;
-
         [[nodiscard]] constexpr Biterator begin() const;
         [[nodiscard]] constexpr Biterator end() const;
 
+    private:
+        u64 mData;
+
         friend class Biterator;
     };
 
@@ -250,8 +250,9 @@ namespace purebred {
         Bitboard res = this->shift<kDir>();
 
         while (true) {
-            const Bitboard temp = (res & ~occ).shift<kDir>();
-            if ((res == (res |= temp))) break;
+            const Bitboard next = res | (res & ~occ).shift<kDir>();
+            if (next == res) break;
+            res = next;
         }
 
         return res;
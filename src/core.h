@@ -22,7 +22,7 @@
 #include "utils/mdarray.h"
 
 #include <cassert>
-#include <regex>
+#include <string>
 #include <string_view>
 
 namespace purebred {
@@ -359,29 +359,24 @@ namespace purebred {
             mData = (r << 3 | f);
         }
 
-        [[nodiscard]] static constexpr Square from_str(std::string &str) {
-
-            // As regex is not yet implemented constexpr in C++20, do the matching manually instead
-            bool match = [&]() {
-                if (str.size() != 2) return false;
-                if (str[0] < 'a' || str[0] > 'h') return false;
-                if (str[1] < '1' || str[1] > '8') return false;
-                return true;
-            }();
-
-            if (!match) return Square{kNoneIdx};
-
+        [[nodiscard]] static constexpr Square from_str(std::string_view str) {
+            if (str.size() != 2 || str[0] < 'a' || str[0] > 'h' || str[1] < '1' || str[1] > '8') return Square{kNoneIdx};
             return Square{str[1] - '1', str[0] - 'a'};
         }
 
-        [[nodiscard]] constexpr std::string to_str() const {
+        // Writes the two characters of the square's name and returns the end of what was written
+        constexpr char *write(char *out) const {
             assert(mData != kNoneIdx);
 
-            std::string str;
-            str += 'a' + this->file();
-            str += '1' + this->rank();
+            *out++ = static_cast<char>('a' + this->file());
+            *out++ = static_cast<char>('1' + this->rank());
 
-            return str;
+            return out;
+        }
+
+        [[nodiscard]] constexpr std::string to_str() const {
+            utils::MDArray<char, 2> str;
+            return std::string(str.data(), this->write(str.data()));
         }
 
         [[nodiscard]] constexpr u8 rank() const {
@@ -0,0 +1,94 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "attacks.h"
+#include "core.h"
+#include "move.h"
+#include "types.h"
+#include "utils/mdarray.h"
+#include "zobrist.h"
+
+#include <cassert>
+#include <utility>
+
+// Tables for detecting upcoming repetitions (see Marcel van Kervinck, "The cuckoo cycle").
+// Every reversible move of a non-pawn piece on an empty board is stored by the Zobrist key difference it
+// produces, in a cuckoo hash table indexed by two independent hashes of that difference.
+namespace purebred::cuckoo {
+
+    constexpr usize kSize = 8192;
+    constexpr usize kNumMoves = 3668;
+
+    inline utils::MDArray<u64, kSize> keys;
+    inline utils::MDArray<Move, kSize> moves;
+
+    [[nodiscard]] constexpr usize h1(u64 key) {
+        return key & (kSize - 1);
+    }
+
+    [[nodiscard]] constexpr usize h2(u64 key) {
+        return (key >> 16) & (kSize - 1);
+    }
+
+    // Attacks of a piece on an empty board
+    [[nodiscard]] inline Bitboard pseudo_attacks(PieceType pt, Square sq) {
+        if (pt == PieceTypes::kKnight) return attacks::get_knight_attacks(sq);
+        if (pt == PieceTypes::kBishop) return attacks::get_bishop_attacks(sq);
+        if (pt == PieceTypes::kRook) return attacks::get_rook_attacks(sq);
+        if (pt == PieceTypes::kQueen) return attacks::get_queen_attacks(sq);
+        return attacks::get_king_attacks(sq);
+    }
+
+    // Must be called after attacks::init()
+    inline void init() {
+        keys.fill(0);
+        moves.fill(Moves::kNone);
+
+        [[maybe_unused]] usize count = 0;
+        for (usize pcIdx = 0; pcIdx < Piece::kNumTypes; ++pcIdx) {
+            const Piece pc{pcIdx};
+            if (pc.type() == PieceTypes::kPawn) continue;
+
+            for (usize s1 = 0; s1 < Square::kNumTypes; ++s1) {
+                for (usize s2 = s1 + 1; s2 < Square::kNumTypes; ++s2) {
+                    const Square from{s1}, to{s2};
+                    if (!(pseudo_attacks(pc.type(), from) & Bitboard{to})) continue;
+
+                    u64 key = zobrist::piece_square(pc, from) ^ zobrist::piece_square(pc, to) ^ zobrist::stm();
+                    Move move = Move::create<Move::Type::kNormal>(from, to);
+
+                    // Insert, kicking out whichever entry was there and reinserting it into its other slot
+                    usize slot = h1(key);
+                    while (true) {
+                        std::swap(keys[slot], key);
+                        std::swap(moves[slot], move);
+                        if (move == Moves::kNone) break;
+                        slot = slot == h1(key) ? h2(key) : h1(key);
+                    }
+
+                    count++;
+                }
+            }
+        }
+
+        assert(count == kNumMoves);
+    }
+}
@@ -0,0 +1,335 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "datagen.h"
+
+#include "movegen.h"
+#include "packed.h"
+#include "position.h"
+#include "search.h"
+#include "tt.h"
+#include "utils/parse.h"
+#include "utils/prng.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace purebred::datagen {
+
+    namespace {
+        constexpr usize kThreadHashMB = 8;
+        constexpr usize kFlushRecords = 1 << 16;
+
+        // Openings whose evaluation is already this lopsided are discarded
+        constexpr Score kMaxOpeningScore = 1000;
+        constexpr i32 kVerificationDepth = 8;
+
+        // Adjudication thresholds
+        constexpr Score kWinScore = 2500;
+        constexpr i32 kWinPlies = 4;
+        constexpr Score kDrawScore = 10;
+        constexpr i32 kDrawPlies = 12;
+        constexpr usize kMinDrawPly = 80;
+
+        struct Options {
+            std::string output;
+            u64 games = 1000;
+            usize threads = 1;
+            u64 nodes = 5000;
+            i32 randomPlies = 8;
+            u64 seed = 0;
+        };
+
+        // Serialises the large per-thread flushes into the shared output file. Once a write fails, nothing more
+        // is written, and the games still being played are abandoned.
+        class Output {
+        public:
+            explicit Output(std::FILE *file) : mFile(file) {}
+
+            void write(const std::vector<PackedBoard> &records) {
+                std::lock_guard lock{mMutex};
+                if (this->failed()) return;
+
+                const bool ok = std::fwrite(records.data(), sizeof(PackedBoard), records.size(), mFile) == records.size()
+                             && std::fflush(mFile) == 0;
+                if (!ok) mFailed.store(true, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] bool failed() const {
+                return mFailed.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::FILE *mFile;
+            std::mutex mMutex;
+            std::atomic<bool> mFailed = false;
+        };
+
+        struct Progress {
+            std::atomic<u64> gamesStarted = 0;
+            std::atomic<u64> gamesFinished = 0;
+            std::atomic<u64> positions = 0;
+        };
+
+        // Plays random legal moves from the start position. Returns false if the game ended during the opening.
+        bool play_random_opening(Position &pos, utils::PRNG &prng, i32 plies) {
+            for (i32 i = 0; i < plies; ++i) {
+                MoveList moves;
+                movegen::generate_legal(pos, moves);
+                if (moves.empty()) return false;
+                pos.make_move(moves[prng.next_bounded(moves.size())]);
+            }
+
+            MoveList moves;
+            movegen::generate_legal(pos, moves);
+            return !moves.empty() && !pos.is_draw();
+        }
+
+        class GameRunner {
+        public:
+            GameRunner(const Options &options, Output &output, Progress &progress, u64 seed)
+                : mOptions(options), mOutput(output), mProgress(progress), mPrng(seed) {
+                mTT.resize(kThreadHashMB);
+                mWorker = std::make_unique<search::Worker>(mTT, mStop);
+                mBuffer.reserve(kFlushRecords);
+            }
+
+            void run() {
+                while (!mOutput.failed() && mProgress.gamesStarted.fetch_add(1, std::memory_order_relaxed) < mOptions.games) {
+                    this->play_game();
+                    mProgress.gamesFinished.fetch_add(1, std::memory_order_relaxed);
+                    if (mBuffer.size() >= kFlushRecords) this->flush();
+                }
+
+                this->flush();
+            }
+
+        private:
+            const Options &mOptions;
+            Output &mOutput;
+            Progress &mProgress;
+            utils::PRNG mPrng;
+
+            TranspositionTable mTT;
+            std::atomic<bool> mStop = false;
+            std::unique_ptr<search::Worker> mWorker;
+
+            std::vector<PackedBoard> mBuffer;
+            std::vector<PackedBoard> mGame;
+
+            search::SearchResult search(const Position &pos, const search::Limits &limits) {
+                mStop.store(false, std::memory_order_relaxed);
+                return mWorker->run(pos, limits, search::Worker::Role::kSilent);
+            }
+
+            Position pick_opening() {
+                search::Limits verification;
+                verification.depth = kVerificationDepth;
+
+                while (true) {
+                    Position pos = Position::startpos();
+
+                    // Randomising the parity of the opening length gives both colours positions to move
+                    const i32 plies = mOptions.randomPlies + static_cast<i32>(mPrng.next_bounded(2));
+                    if (!play_random_opening(pos, mPrng, plies)) continue;
+
+                    const search::SearchResult result = this->search(pos, verification);
+                    if (std::abs(result.score) <= kMaxOpeningScore) return pos;
+                }
+            }
+
+            void play_game() {
+                mTT.clear();
+                mWorker->clear();
+                mGame.clear();
+
+                Position pos = this->pick_opening();
+                pos.reserve(kMaxPly * 2);
+
+                search::Limits limits;
+                limits.nodes = mOptions.nodes;
+
+                i32 winPlies = 0, lossPlies = 0, drawPlies = 0;
+                u8 wdl;
+
+                while (true) {
+                    MoveList moves;
+                    movegen::generate_legal(pos, moves);
+
+                    if (moves.empty()) {
+                        wdl = !pos.in_check() ? WDL::kDraw : pos.stm() == Colours::kWhite ? WDL::kBlackWin : WDL::kWhiteWin;
+                        break;
+                    }
+
+                    if (pos.is_draw()) {
+                        wdl = WDL::kDraw;
+                        break;
+                    }
+
+                    const search::SearchResult result = this->search(pos, limits);
+                    const Score whiteScore = pos.stm() == Colours::kWhite ? result.score : -result.score;
+
+                    // Adjudicate clearly decided games rather than playing them out
+                    winPlies = whiteScore >= kWinScore ? winPlies + 1 : 0;
+                    lossPlies = whiteScore <= -kWinScore ? lossPlies + 1 : 0;
+                    drawPlies = pos.game_ply() >= kMinDrawPly && std::abs(whiteScore) <= kDrawScore ? drawPlies + 1 : 0;
+
+                    if (winPlies >= kWinPlies) {
+                        wdl = WDL::kWhiteWin;
+                        break;
+                    }
+                    if (lossPlies >= kWinPlies) {
+                        wdl = WDL::kBlackWin;
+                        break;
+                    }
+                    if (drawPlies >= kDrawPlies) {
+                        wdl = WDL::kDraw;
+                        break;
+                    }
+
+                    // Only keep quiet positions with non-mate scores, as those are what the network learns from
+                    const Move best = result.bestMove;
+                    if (!pos.in_check() && !pos.is_noisy(best) && std::abs(result.score) < Scores::kMateInMaxPly)
+                        mGame.push_back(PackedBoard::pack(pos, whiteScore, WDL::kDraw));
+
+                    pos.make_move(best);
+                }
+
+                for (PackedBoard &record : mGame) record.wdl = wdl;
+                mBuffer.insert(mBuffer.end(), mGame.begin(), mGame.end());
+                mProgress.positions.fetch_add(mGame.size(), std::memory_order_relaxed);
+            }
+
+            void flush() {
+                if (mBuffer.empty()) return;
+                mOutput.write(mBuffer);
+                mBuffer.clear();
+            }
+        };
+
+        bool parse_options(i32 argc, char *argv[], Options &options) {
+            for (i32 i = 2; i < argc; ++i) {
+                const std::string_view flag = argv[i];
+                if (i + 1 >= argc) {
+                    std::cerr << "Missing value for " << flag << std::endl;
+                    return false;
+                }
+
+                const std::string_view value = argv[++i];
+                bool ok = true;
+
+                if (flag == "--output") options.output = value;
+                else if (flag == "--games") {
+                    const auto games = utils::parse_int<u64>(value);
+                    ok = games && *games > 0;
+                    if (ok) options.games = *games;
+                } else if (flag == "--threads") {
+                    const auto threads = utils::parse_int<usize>(value);
+                    ok = threads && *threads > 0;
+                    if (ok) options.threads = *threads;
+                } else if (flag == "--nodes") {
+                    const auto nodes = utils::parse_int<u64>(value);
+                    ok = nodes && *nodes > 0;
+                    if (ok) options.nodes = *nodes;
+                } else if (flag == "--random-plies") {
+                    const auto plies = utils::parse_int<i32>(value);
+                    ok = plies && *plies >= 0;
+                    if (ok) options.randomPlies = *plies;
+                } else if (flag == "--seed") {
+                    const auto seed = utils::parse_int<u64>(value);
+                    ok = seed.has_value();
+                    if (ok) options.seed = *seed;
+                } else {
+                    std::cerr << "Unknown option " << flag << std::endl;
+                    return false;
+                }
+
+                if (!ok) {
+                    std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+                    return false;
+                }
+            }
+
+            if (options.output.empty()) {
+                std::cerr << "Usage: " << argv[0] << " datagen --output <file> [--games N] [--threads T] [--nodes N]"
+                          << " [--random-plies N] [--seed S]" << std::endl;
+                return false;
+            }
+
+            return true;
+        }
+    }
+
+    i32 run(i32 argc, char *argv[]) {
+        Options options;
+        options.seed = static_cast<u64>(std::chrono::steady_clock::now().time_since_epoch().count());
+        if (!parse_options(argc, argv, options)) return 1;
+
+        std::FILE *file = std::fopen(options.output.c_str(), "ab");
+        if (!file) {
+            std::cerr << "Could not open " << options.output << std::endl;
+            return 1;
+        }
+
+        Output output{file};
+        Progress progress;
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (usize i = 0; i < options.threads; ++i) {
+            threads.emplace_back([&options, &output, &progress, i]() {
+                utils::PRNG seeder{options.seed + i};
+                GameRunner runner{options, output, progress, seeder.next()};
+                runner.run();
+            });
+        }
+
+        // Report progress periodically until every game has finished
+        std::atomic<bool> done = false;
+        std::thread reporter{[&]() {
+            while (!done.load(std::memory_order_relaxed)) {
+                for (i32 i = 0; i < 100 && !done.load(std::memory_order_relaxed); ++i)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+                const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count();
+                std::cerr << "Games: " << progress.gamesFinished << "/" << options.games << ", positions: " << progress.positions
+                          << ", positions/s: " << progress.positions / static_cast<u64>(std::max<i64>(elapsed, 1)) << std::endl;
+            }
+        }};
+
+        for (auto &thread : threads) thread.join();
+        done.store(true, std::memory_order_relaxed);
+        reporter.join();
+
+        // A failed write or close means the file is missing records, which must not pass for a finished run
+        const bool closed = std::fclose(file) == 0;
+        if (output.failed() || !closed) {
+            std::cerr << "Could not write " << options.output << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+}
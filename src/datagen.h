@@ -0,0 +1,32 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "types.h"
+
+// Self-play data generation: `Purebred datagen --output <file> [--games N] [--threads T] [--nodes N]
+//                                              [--random-plies N] [--seed S]`
+// Every thread plays its own games at a fixed node count from randomised openings, buffering PackedBoard
+// records and appending them to the output file in large blocks.
+namespace purebred::datagen {
+
+    // Returns the process exit code.
+    [[nodiscard]] i32 run(i32 argc, char *argv[]);
+}
@@ -0,0 +1,324 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "dataprep.h"
+
+#include "movegen.h"
+#include "packed.h"
+#include "position.h"
+#include "utils/mapped_file.h"
+#include "utils/parse.h"
+#include "utils/prng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace purebred::dataprep {
+
+    namespace {
+        // Inputs are split into chunks of this many records, which are handed out to threads in random order,
+        // and each output block is assembled from several chunks before being shuffled.
+        constexpr usize kChunkRecords = 1 << 16;
+        constexpr usize kChunksPerBlock = 8;
+
+        struct Options {
+            std::vector<std::string> inputs;
+            std::string output;
+            usize threads = 1;
+            Score maxScore = Scores::kInf;
+            bool skipCheck = false;
+            bool skipCaptures = false;
+            bool dedup = true;
+            usize hash = 1024;
+            u64 seed = 0;
+        };
+
+        struct Stats {
+            std::atomic<u64> read = 0;
+            std::atomic<u64> written = 0;
+            std::atomic<u64> invalid = 0;
+            std::atomic<u64> filtered = 0;
+            std::atomic<u64> duplicates = 0;
+        };
+
+        struct Chunk {
+            usize file;
+            usize begin;
+            usize end;
+        };
+
+        // A lock-free set of 64-bit keys using linear probing. Zero marks an empty slot.
+        // Deduplication is best-effort: if a probe sequence runs too long the key is simply treated as new,
+        // so a table which is too small degrades gracefully instead of failing.
+        class KeySet {
+        public:
+            KeySet(usize megabytes, u64 expected) {
+                constexpr usize kMinSize = 1024, kMaxSize = usize{1} << 40;
+                const usize wanted = std::bit_ceil(std::clamp<u64>(expected * 2, kMinSize, kMaxSize));
+                const usize budget = std::bit_floor(std::clamp<usize>(megabytes * 1024 * 1024 / sizeof(u64), kMinSize, kMaxSize));
+                mSize = std::min(wanted, budget);
+                mSlots = std::make_unique<std::atomic<u64>[]>(mSize);
+            }
+
+            // Returns true if the key was not yet present.
+            [[nodiscard]] bool insert(u64 key) {
+                key = key ? key : 1;
+
+                usize idx = static_cast<usize>(key) & (mSize - 1);
+                for (usize probe = 0; probe < kMaxProbes; ++probe) {
+                    u64 existing = mSlots[idx].load(std::memory_order_relaxed);
+                    if (existing == 0 && mSlots[idx].compare_exchange_strong(existing, key, std::memory_order_relaxed))
+                        return true;
+                    if (existing == key) return false;
+                    idx = (idx + 1) & (mSize - 1);
+                }
+
+                return true;
+            }
+
+        private:
+            static constexpr usize kMaxProbes = 64;
+
+            std::unique_ptr<std::atomic<u64>[]> mSlots;
+            usize mSize;
+        };
+
+        // Whether the side to move can capture something more valuable than the capturing piece, or something
+        // undefended. Such positions are tactically unresolved, so their scores say little about the static position.
+        bool has_winning_capture(const Position &pos) {
+            constexpr utils::MDArray<i32, PieceType::kNumTypes> kValues = {1, 3, 3, 5, 9, 100};
+
+            MoveList moves;
+            movegen::generate<movegen::GenType::kNoisy>(pos, moves);
+
+            const Colour them = pos.stm().flip();
+            for (Move move : moves) {
+                if (!pos.is_capture(move) || !pos.is_legal(move)) continue;
+
+                const PieceType attacker = pos.piece_on(move.from()).type();
+                const PieceType victim = move.type() == Move::Type::kEnPassant ? PieceTypes::kPawn : pos.piece_on(move.to()).type();
+                if (kValues[victim] > kValues[attacker]) return true;
+
+                const Bitboard occ = pos.pieces() ^ Bitboard{move.from()};
+                if ((pos.attackers_to(move.to(), occ) & pos.pieces(them)).empty()) return true;
+            }
+
+            return false;
+        }
+
+        // Once a write fails, nothing more is written and the remaining chunks are skipped
+        class Output {
+        public:
+            explicit Output(std::FILE *file) : mFile(file) {}
+
+            void write(const std::vector<PackedBoard> &records) {
+                std::lock_guard lock{mMutex};
+                if (this->failed()) return;
+                if (std::fwrite(records.data(), sizeof(PackedBoard), records.size(), mFile) != records.size())
+                    mFailed.store(true, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] bool failed() const {
+                return mFailed.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::FILE *mFile;
+            std::mutex mMutex;
+            std::atomic<bool> mFailed = false;
+        };
+
+        bool parse_options(i32 argc, char *argv[], Options &options) {
+            for (i32 i = 2; i < argc; ++i) {
+                const std::string_view flag = argv[i];
+
+                if (flag == "--skip-check") options.skipCheck = true;
+                else if (flag == "--skip-captures") options.skipCaptures = true;
+                else if (flag == "--no-dedup") options.dedup = false;
+                else {
+                    if (i + 1 >= argc) {
+                        std::cerr << "Missing value for " << flag << std::endl;
+                        return false;
+                    }
+
+                    const std::string_view value = argv[++i];
+                    bool ok = true;
+
+                    if (flag == "--input") options.inputs.emplace_back(value);
+                    else if (flag == "--output") options.output = value;
+                    else if (flag == "--threads") {
+                        const auto threads = utils::parse_int<usize>(value);
+                        ok = threads && *threads > 0;
+                        if (ok) options.threads = *threads;
+                    } else if (flag == "--max-score") {
+                        const auto score = utils::parse_int<Score>(value);
+                        ok = score && *score >= 0;
+                        if (ok) options.maxScore = *score;
+                    } else if (flag == "--hash") {
+                        const auto hash = utils::parse_int<usize>(value);
+                        ok = hash && *hash > 0;
+                        if (ok) options.hash = *hash;
+                    } else if (flag == "--seed") {
+                        const auto seed = utils::parse_int<u64>(value);
+                        ok = seed.has_value();
+                        if (ok) options.seed = *seed;
+                    } else {
+                        std::cerr << "Unknown option " << flag << std::endl;
+                        return false;
+                    }
+
+                    if (!ok) {
+                        std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+                        return false;
+                    }
+                }
+            }
+
+            if (options.inputs.empty() || options.output.empty()) {
+                std::cerr << "Usage: " << argv[0] << " dataprep --input <file> [--input <file> ...] --output <file>"
+                          << " [--threads T] [--max-score N] [--skip-check] [--skip-captures] [--no-dedup]"
+                          << " [--hash MB] [--seed S]" << std::endl;
+                return false;
+            }
+
+            return true;
+        }
+    }
+
+    i32 run(i32 argc, char *argv[]) {
+        Options options;
+        options.seed = static_cast<u64>(std::chrono::steady_clock::now().time_since_epoch().count());
+        if (!parse_options(argc, argv, options)) return 1;
+
+        std::vector<utils::MappedFile> files(options.inputs.size());
+        std::vector<Chunk> chunks;
+        u64 totalRecords = 0;
+
+        for (usize i = 0; i < options.inputs.size(); ++i) {
+            if (!files[i].open(options.inputs[i])) {
+                std::cerr << "Could not map " << options.inputs[i] << std::endl;
+                return 1;
+            }
+
+            if (files[i].size() % sizeof(PackedBoard)) {
+                std::cerr << "Warning: " << options.inputs[i] << " has a trailing partial record, which is ignored" << std::endl;
+            }
+
+            const usize records = files[i].size() / sizeof(PackedBoard);
+            for (usize begin = 0; begin < records; begin += kChunkRecords)
+                chunks.push_back({i, begin, std::min(begin + kChunkRecords, records)});
+            totalRecords += records;
+        }
+
+        // Visiting chunks in random order interleaves the inputs, and separates positions from the same game
+        utils::PRNG shuffler{options.seed};
+        for (usize i = chunks.size(); i > 1; --i) std::swap(chunks[i - 1], chunks[shuffler.next_bounded(i)]);
+
+        std::FILE *file = std::fopen(options.output.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Could not open " << options.output << std::endl;
+            return 1;
+        }
+
+        Output output{file};
+        std::unique_ptr<KeySet> keys = options.dedup ? std::make_unique<KeySet>(options.hash, totalRecords) : nullptr;
+        Stats stats;
+        std::atomic<usize> nextChunk = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (usize t = 0; t < options.threads; ++t) {
+            threads.emplace_back([&, t]() {
+                utils::PRNG prng{options.seed ^ (t + 1) * U64C(0x9E3779B97F4A7C15)};
+                Position pos;
+                std::vector<PackedBoard> block;
+                block.reserve(kChunkRecords * kChunksPerBlock);
+
+                const auto flush = [&]() {
+                    for (usize i = block.size(); i > 1; --i) std::swap(block[i - 1], block[prng.next_bounded(i)]);
+                    output.write(block);
+                    stats.written.fetch_add(block.size(), std::memory_order_relaxed);
+                    block.clear();
+                };
+
+                for (usize c = nextChunk.fetch_add(1); c < chunks.size() && !output.failed(); c = nextChunk.fetch_add(1)) {
+                    const Chunk &chunk = chunks[c];
+                    const auto *records = reinterpret_cast<const PackedBoard *>(files[chunk.file].data());
+                    files[chunk.file].prefetch(chunk.begin * sizeof(PackedBoard), (chunk.end - chunk.begin) * sizeof(PackedBoard));
+
+                    for (usize i = chunk.begin; i < chunk.end; ++i) {
+                        const PackedBoard &record = records[i];
+
+                        if (std::abs(record.score) > options.maxScore) {
+                            stats.filtered.fetch_add(1, std::memory_order_relaxed);
+                            continue;
+                        }
+
+                        if (!pos.set_packed(record)) {
+                            stats.invalid.fetch_add(1, std::memory_order_relaxed);
+                            continue;
+                        }
+
+                        if ((options.skipCheck && pos.in_check()) || (options.skipCaptures && has_winning_capture(pos))) {
+                            stats.filtered.fetch_add(1, std::memory_order_relaxed);
+                            continue;
+                        }
+
+                        if (keys && !keys->insert(pos.key())) {
+                            stats.duplicates.fetch_add(1, std::memory_order_relaxed);
+                            continue;
+                        }
+
+                        block.push_back(record);
+                    }
+
+                    stats.read.fetch_add(chunk.end - chunk.begin, std::memory_order_relaxed);
+                    if (block.size() >= kChunkRecords * (kChunksPerBlock - 1)) flush();
+                }
+
+                if (!block.empty()) flush();
+            });
+        }
+
+        for (auto &thread : threads) thread.join();
+
+        // A failed write or close leaves a truncated dataset, which must not pass for a finished run
+        const bool closed = std::fclose(file) == 0;
+        if (output.failed() || !closed) {
+            std::cerr << "Could not write " << options.output << std::endl;
+            return 1;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Read " << stats.read << " records in " << elapsed << " ms: wrote " << stats.written
+                  << ", filtered " << stats.filtered << ", duplicates " << stats.duplicates
+                  << ", invalid " << stats.invalid << std::endl;
+
+        return 0;
+    }
+}
@@ -0,0 +1,33 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "types.h"
+
+// Training data preparation: `Purebred dataprep --input <file> [--input <file> ...] --output <file> [--threads T]
+//                                               [--max-score N] [--skip-check] [--skip-captures] [--no-dedup]
+//                                               [--hash MB] [--seed S]`
+// Memory-maps PackedBoard files, drops unwanted positions and duplicates, and writes the survivors in
+// shuffled blocks which each interleave several distant regions of the input.
+namespace purebred::dataprep {
+
+    // Returns the process exit code.
+    [[nodiscard]] i32 run(i32 argc, char *argv[]);
+}
@@ -0,0 +1,130 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "eval.h"
+
+#include "attackmap.h"
+#include "nnue.h"
+
+#include <algorithm>
+
+namespace purebred::eval {
+
+    namespace {
+        struct PhaseScore {
+            i32 mg;
+            i32 eg;
+
+            [[nodiscard]] constexpr bool operator==(const PhaseScore &) const = default;
+        };
+
+        constexpr utils::MDArray<PhaseScore, PieceType::kNumTypes> kPieceValues = {
+            PhaseScore{82, 94}, PhaseScore{337, 281}, PhaseScore{365, 297},
+            PhaseScore{477, 512}, PhaseScore{1025, 936}, PhaseScore{0, 0}
+        };
+
+        // Bonus per square attacked by each piece type which is neither our own nor covered by an enemy pawn
+        constexpr utils::MDArray<PhaseScore, PieceType::kNumTypes> kControlWeights = {
+            PhaseScore{0, 0}, PhaseScore{4, 4}, PhaseScore{5, 5},
+            PhaseScore{2, 4}, PhaseScore{1, 2}, PhaseScore{0, 0}
+        };
+
+        constexpr utils::MDArray<i32, PieceType::kNumTypes> kPhaseWeights = {0, 1, 1, 2, 4, 0};
+        constexpr i32 kMaxPhase = 24;
+        constexpr Score kTempo = 10;
+
+        // Piece-square bonuses are derived from a few simple terms rather than stored as hand-written tables.
+        // Squares are from White's point of view; Black's squares are flipped vertically.
+        constexpr PhaseScore piece_square_bonus(PieceType pt, Square sq) {
+            const i32 rank = sq.rank(), file = sq.file();
+
+            // Distance from the centre: 0 on the four centre squares, up to 3 in the corners.
+            const i32 centreDist = std::max(std::max(3 - file, file - 4), std::max(3 - rank, rank - 4));
+            const i32 centrality = 3 - centreDist;
+
+            switch (pt.raw()) {
+                case PieceTypes::kPawn.raw(): {
+                    const i32 centreFile = (file == Files::kD || file == Files::kE) && (rank == Ranks::k4 || rank == Ranks::k5);
+                    return {(rank - 1) * 5 + centreFile * 15, (rank - 1) * 12};
+                }
+                case PieceTypes::kKnight.raw():
+                    return {centrality * 12 - 18, centrality * 8 - 12};
+                case PieceTypes::kBishop.raw():
+                    return {centrality * 6 - 6, centrality * 4 - 6};
+                case PieceTypes::kRook.raw():
+                    return {(rank == Ranks::k7) * 20 + (file == Files::kD || file == Files::kE) * 5, (rank == Ranks::k7) * 10};
+                case PieceTypes::kQueen.raw():
+                    return {centrality * 3 - 5, centrality * 8 - 10};
+                case PieceTypes::kKing.raw(): {
+                    const i32 sheltered = rank == Ranks::k1 && (file <= Files::kC || file >= Files::kG);
+                    return {sheltered * 25 - rank * 15, centrality * 14 - 20};
+                }
+                default:
+                    return {0, 0};
+            }
+        }
+
+        constexpr utils::MDArray<PhaseScore, Piece::kNumTypes, Square::kNumTypes> kPsqt = []() {
+            utils::MDArray<PhaseScore, Piece::kNumTypes, Square::kNumTypes> psqt{};
+            for (usize pc = 0; pc < Piece::kNumTypes; ++pc) {
+                const Piece piece{pc};
+                const PieceType pt = piece.type();
+                for (Square sq : Squares::kAll) {
+                    const PhaseScore bonus = piece_square_bonus(pt, sq.orient(piece.colour()));
+                    psqt[pc][sq] = {kPieceValues[pt].mg + bonus.mg, kPieceValues[pt].eg + bonus.eg};
+                }
+            }
+            return psqt;
+        }();
+    }
+
+    Score evaluate(const Position &pos) {
+        if (nnue::loaded()) return nnue::evaluate(pos);
+
+        utils::MDArray<PhaseScore, Colour::kNumTypes> scores = {PhaseScore{0, 0}, PhaseScore{0, 0}};
+        i32 phase = 0;
+
+        for (Square sq : pos.pieces()) {
+            const Piece pc = pos.piece_on(sq);
+            scores[pc.colour()].mg += kPsqt[pc][sq].mg;
+            scores[pc.colour()].eg += kPsqt[pc][sq].eg;
+            phase += kPhaseWeights[pc.type()];
+        }
+
+        const utils::MDArray<attacks::AttackMap, Colour::kNumTypes> maps = {
+            attacks::attack_map(pos, Colours::kWhite), attacks::attack_map(pos, Colours::kBlack)
+        };
+
+        for (Colour c : {Colours::kWhite, Colours::kBlack}) {
+            const Bitboard targets = ~pos.pieces(c) & ~maps[c.flip()].byType[PieceTypes::kPawn];
+            for (PieceType pt : {PieceTypes::kKnight, PieceTypes::kBishop, PieceTypes::kRook, PieceTypes::kQueen}) {
+                const i32 count = (maps[c].byType[pt] & targets).count_bits();
+                scores[c].mg += kControlWeights[pt].mg * count;
+                scores[c].eg += kControlWeights[pt].eg * count;
+            }
+        }
+
+        const Colour us = pos.stm(), them = us.flip();
+        const i32 mg = scores[us].mg - scores[them].mg;
+        const i32 eg = scores[us].eg - scores[them].eg;
+
+        phase = std::min(phase, kMaxPhase);
+        return (mg * phase + eg * (kMaxPhase - phase)) / kMaxPhase + kTempo;
+    }
+}
@@ -0,0 +1,264 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "evalbatch.h"
+
+#include "eval.h"
+#include "nnue.h"
+#include "packed.h"
+#include "position.h"
+#include "utils/mapped_file.h"
+#include "utils/parse.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace purebred::evalbatch {
+
+    namespace {
+        // Positions are read, evaluated in parallel and written in batches of this size, which keeps the output
+        // in input order without holding the whole file in memory.
+        constexpr usize kBatchSize = 1 << 16;
+
+        enum class Format {
+            kFen,
+            kPacked
+        };
+
+        struct Options {
+            std::string input;
+            std::string output;
+            std::string net;
+            Format format = Format::kFen;
+            usize threads = 1;
+        };
+
+        // Calls fn(thread, i) for every i in [0, count), splitting the range evenly over the threads, numbered
+        // from 0 so that each can keep its own scratch state
+        template <typename Fn>
+        void parallel_for(usize count, usize threads, const Fn &fn) {
+            std::vector<std::thread> workers;
+            const usize perThread = (count + threads - 1) / threads;
+
+            for (usize begin = 0; begin < count; begin += perThread) {
+                const usize end = std::min(begin + perThread, count);
+                workers.emplace_back([&fn, thread = workers.size(), begin, end]() {
+                    for (usize i = begin; i < end; ++i) fn(thread, i);
+                });
+            }
+
+            for (auto &worker : workers) worker.join();
+        }
+
+        bool parse_options(i32 argc, char *argv[], Options &options) {
+            for (i32 i = 2; i < argc; ++i) {
+                const std::string_view flag = argv[i];
+                if (i + 1 >= argc) {
+                    std::cerr << "Missing value for " << flag << std::endl;
+                    return false;
+                }
+
+                const std::string_view value = argv[++i];
+                bool ok = true;
+
+                if (flag == "--input") options.input = value;
+                else if (flag == "--output") options.output = value;
+                else if (flag == "--net") options.net = value;
+                else if (flag == "--format") {
+                    ok = value == "fen" || value == "packed";
+                    options.format = value == "packed" ? Format::kPacked : Format::kFen;
+                } else if (flag == "--threads") {
+                    const auto threads = utils::parse_int<usize>(value);
+                    ok = threads && *threads > 0;
+                    if (ok) options.threads = *threads;
+                } else {
+                    std::cerr << "Unknown option " << flag << std::endl;
+                    return false;
+                }
+
+                if (!ok) {
+                    std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+                    return false;
+                }
+            }
+
+            if (options.input.empty() || (options.format == Format::kPacked && options.output.empty())) {
+                std::cerr << "Usage: " << argv[0] << " evalbatch --input <file> [--output <file>] [--net <file>]"
+                          << " [--format fen|packed] [--threads T]" << std::endl
+                          << "Packed input requires an output file." << std::endl;
+                return false;
+            }
+
+            return true;
+        }
+
+        [[nodiscard]] bool run_fen(const Options &options, u64 &evaluated, u64 &invalid) {
+            std::ifstream inFile;
+            if (options.input != "-") {
+                inFile.open(options.input);
+                if (!inFile) {
+                    std::cerr << "Could not open " << options.input << std::endl;
+                    return false;
+                }
+            }
+
+            std::ofstream outFile;
+            if (!options.output.empty()) {
+                outFile.open(options.output);
+                if (!outFile) {
+                    std::cerr << "Could not open " << options.output << std::endl;
+                    return false;
+                }
+            }
+
+            std::istream &in = options.input != "-" ? static_cast<std::istream &>(inFile) : std::cin;
+            std::ostream &out = !options.output.empty() ? static_cast<std::ostream &>(outFile) : std::cout;
+
+            std::vector<std::string> lines;
+            std::vector<std::string> results(kBatchSize);
+            std::atomic<u64> bad = 0;
+            u64 positions = 0;
+
+            while (true) {
+                lines.clear();
+                std::string line;
+                while (lines.size() < kBatchSize && std::getline(in, line)) lines.push_back(std::move(line));
+                if (lines.empty()) break;
+
+                parallel_for(lines.size(), options.threads, [&](usize, usize i) {
+                    std::string &fen = lines[i];
+                    while (!fen.empty() && std::isspace(static_cast<unsigned char>(fen.back()))) fen.pop_back();
+
+                    results[i].clear();
+                    if (fen.empty() || fen[0] == '#') return;
+
+                    const auto pos = Position::from_fen(fen);
+                    if (!pos) {
+                        results[i] = fen + " ; error invalid position";
+                        bad.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+
+                    results[i] = fen + " ; eval " + std::to_string(eval::evaluate(*pos));
+                });
+
+                for (usize i = 0; i < lines.size(); ++i) {
+                    if (!results[i].empty()) out << results[i] << '\n';
+                    positions += !results[i].empty();
+                }
+                out.flush();
+            }
+
+            if (!out) {
+                std::cerr << "Could not write " << (options.output.empty() ? "the output" : options.output) << std::endl;
+                return false;
+            }
+
+            invalid = bad;
+            evaluated = positions - invalid;
+            return true;
+        }
+
+        [[nodiscard]] bool run_packed(const Options &options, u64 &evaluated, u64 &invalid) {
+            utils::MappedFile file;
+            if (!file.open(options.input)) {
+                std::cerr << "Could not map " << options.input << std::endl;
+                return false;
+            }
+
+            if (file.size() % sizeof(PackedBoard)) {
+                std::cerr << "Warning: " << options.input << " has a trailing partial record, which is ignored" << std::endl;
+            }
+
+            std::FILE *out = std::fopen(options.output.c_str(), "wb");
+            if (!out) {
+                std::cerr << "Could not open " << options.output << std::endl;
+                return false;
+            }
+
+            const auto *records = reinterpret_cast<const PackedBoard *>(file.data());
+            const usize count = file.size() / sizeof(PackedBoard);
+
+            std::vector<PackedBoard> batch(kBatchSize);
+            std::vector<u8> valid(kBatchSize);
+            std::vector<Position> positions(options.threads);
+            for (usize begin = 0; begin < count; begin += kBatchSize) {
+                const usize size = std::min(kBatchSize, count - begin);
+
+                parallel_for(size, options.threads, [&](usize thread, usize i) {
+                    Position &pos = positions[thread];
+                    batch[i] = records[begin + i];
+                    valid[i] = pos.set_packed(batch[i]);
+                    if (!valid[i]) return;
+
+                    const Score score = eval::evaluate(pos);
+                    batch[i].score = static_cast<i16>(pos.stm() == Colours::kWhite ? score : -score);
+                });
+
+                // Invalid records are dropped, so the survivors are compacted before writing
+                usize kept = 0;
+                for (usize i = 0; i < size; ++i) {
+                    if (valid[i]) batch[kept++] = batch[i];
+                }
+
+                if (std::fwrite(batch.data(), sizeof(PackedBoard), kept, out) != kept) break;
+                evaluated += kept;
+                invalid += size - kept;
+            }
+
+            // A short write or a failed close leaves a truncated file, which must not pass for a finished run
+            const bool written = !std::ferror(out);
+            if (std::fclose(out) != 0 || !written) {
+                std::cerr << "Could not write " << options.output << std::endl;
+                return false;
+            }
+            return true;
+        }
+    }
+
+    i32 run(i32 argc, char *argv[]) {
+        Options options;
+        if (!parse_options(argc, argv, options)) return 1;
+
+        if (!options.net.empty() && !nnue::load(options.net)) {
+            std::cerr << "Could not load network " << options.net << std::endl;
+            return 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        u64 evaluated = 0, invalid = 0;
+        const bool ok = options.format == Format::kPacked ? run_packed(options, evaluated, invalid) : run_fen(options, evaluated, invalid);
+        if (!ok) return 1;
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Evaluated " << evaluated << " positions (" << invalid << " invalid) in " << elapsed << " ms ("
+                  << evaluated * 1000 / static_cast<u64>(std::max<i64>(elapsed, 1)) << " positions/s) with the "
+                  << (nnue::loaded() ? "network" : "handcrafted evaluation") << std::endl;
+
+        return 0;
+    }
+}
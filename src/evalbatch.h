@@ -0,0 +1,34 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "types.h"
+
+// Batched static evaluation: `Purebred evalbatch --input <file> [--output <file>] [--net <file>]
+//                                               [--format fen|packed] [--threads T]`
+// Evaluates every position of a file without searching, loading the given network (or using the handcrafted
+// evaluation without one). FEN/EPD input produces one "<line> ; eval <cp>" line per position, from the side to
+// move's point of view. Packed input is relabelled: each valid record is written back with its score replaced
+// by the evaluation from white's point of view.
+namespace purebred::evalbatch {
+
+    // Returns the process exit code.
+    [[nodiscard]] i32 run(i32 argc, char *argv[]);
+}
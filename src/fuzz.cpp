@@ -0,0 +1,519 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fuzz.h"
+
+#include "attacks.h"
+#include "bench.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "position.h"
+#include "stats.h"
+#include "utils/parse.h"
+#include "utils/prng.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace purebred::fuzz {
+
+    namespace {
+        // Long enough to reach endgames, short enough that the accumulator stack never runs out of plies
+        constexpr usize kMaxGamePlies = 200;
+
+        // Random 16-bit moves offered to the TT move validation at each position
+        constexpr usize kRandomMoves = 32;
+
+        // Stop reporting after this many failures; the first few are the interesting ones
+        constexpr usize kMaxReports = 20;
+
+        struct Options {
+            u64 games = 1000;
+            u64 seed = 1;
+            std::string net;
+        };
+
+        // The board as a plain array of pieces, which the reference code works on
+        using Board = utils::MDArray<Piece, Square::kNumTypes>;
+
+        [[nodiscard]] Piece piece_at(const Board &board, i32 rank, i32 file) {
+            if (rank < 0 || rank >= Ranks::kNum || file < 0 || file >= Files::kNum) return Pieces::kNone;
+            return board[Square{rank, file}];
+        }
+
+        [[nodiscard]] Bitboard occupancy(const Board &board) {
+            Bitboard occ = Bitboards::kEmpty;
+            for (Square sq : Squares::kAll) {
+                if (board[sq]) occ.set_bit(sq);
+            }
+            return occ;
+        }
+
+        // The squares attacked by the piece on sq, worked out square by square rather than from tables
+        [[nodiscard]] Bitboard reference_attacks(const Board &board, Square sq) {
+            constexpr utils::MDArray<i32, 8, 2> kKnightSteps = {{{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}};
+            constexpr utils::MDArray<i32, 8, 2> kKingSteps = {{{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}}};
+
+            const Piece pc = board[sq];
+            const i32 rank = sq.rank(), file = sq.file();
+            Bitboard result = Bitboards::kEmpty;
+
+            const auto add_steps = [&](const utils::MDArray<i32, 8, 2> &steps) {
+                for (const auto &step : steps) {
+                    const i32 r = rank + step[0], f = file + step[1];
+                    if (r >= 0 && r < Ranks::kNum && f >= 0 && f < Files::kNum) result.set_bit(Square{r, f});
+                }
+            };
+
+            if (pc.type() == PieceTypes::kPawn) {
+                const i32 r = rank + (pc.colour() == Colours::kWhite ? 1 : -1);
+                for (i32 f : {file - 1, file + 1}) {
+                    if (r >= 0 && r < Ranks::kNum && f >= 0 && f < Files::kNum) result.set_bit(Square{r, f});
+                }
+            }
+            else if (pc.type() == PieceTypes::kKnight) add_steps(kKnightSteps);
+            else if (pc.type() == PieceTypes::kKing) add_steps(kKingSteps);
+            else {
+                const Bitboard occ = occupancy(board);
+                if (pc.type() != PieceTypes::kRook) result |= attacks::runtime_bishop_attacks(sq, occ);
+                if (pc.type() != PieceTypes::kBishop) result |= attacks::runtime_rook_attacks(sq, occ);
+            }
+
+            return result;
+        }
+
+        [[nodiscard]] Bitboard reference_attackers(const Board &board, Square target, Colour by) {
+            Bitboard attackers = Bitboards::kEmpty;
+            for (Square sq : Squares::kAll) {
+                if (board[sq] && board[sq].colour() == by && reference_attacks(board, sq).get_bit(target)) attackers.set_bit(sq);
+            }
+            return attackers;
+        }
+
+        [[nodiscard]] Square find_king(const Board &board, Colour c) {
+            for (Square sq : Squares::kAll) {
+                if (board[sq] == Piece{c, PieceTypes::kKing}) return sq;
+            }
+            return Squares::kNone;
+        }
+
+        // Plays a move on a copy of the board
+        [[nodiscard]] Board reference_make(Board board, Move move) {
+            const Square from = move.from(), to = move.to();
+            const Piece moved = board[from];
+
+            switch (move.type()) {
+                case Move::Type::kCastling: {
+                    const Piece rook = board[to];
+                    board[from] = Pieces::kNone;
+                    board[to] = Pieces::kNone;
+                    board[move.castle_king_to()] = moved;
+                    board[move.castle_rook_to()] = rook;
+                    break;
+                }
+
+                case Move::Type::kEnPassant:
+                    board[Square{from.rank(), to.file()}] = Pieces::kNone;
+                    [[fallthrough]];
+
+                case Move::Type::kNormal:
+                    board[to] = moved;
+                    board[from] = Pieces::kNone;
+                    break;
+
+                case Move::Type::kPromotion:
+                    board[to] = Piece{moved.colour(), move.promo_type()};
+                    board[from] = Pieces::kNone;
+                    break;
+            }
+
+            return board;
+        }
+
+        // Every legal move, found by trying each piece's moves and keeping those which leave our king safe
+        [[nodiscard]] std::vector<Move> reference_moves(const Position &pos) {
+            Board board;
+            for (Square sq : Squares::kAll) board[sq] = pos.piece_on(sq);
+
+            const Colour us = pos.stm(), them = us.flip();
+            const i32 forward = us == Colours::kWhite ? 1 : -1;
+            const i32 startRank = us == Colours::kWhite ? Ranks::k2 : Ranks::k7;
+            const i32 promoRank = us == Colours::kWhite ? Ranks::k8 : Ranks::k1;
+            std::vector<Move> candidates;
+
+            const auto add_pawn_move = [&](Square from, Square to) {
+                if (to.rank() != promoRank) {
+                    candidates.push_back(Move::create<Move::Type::kNormal>(from, to));
+                    return;
+                }
+                for (PieceType promo : {PieceTypes::kKnight, PieceTypes::kBishop, PieceTypes::kRook, PieceTypes::kQueen})
+                    candidates.push_back(Move::create<Move::Type::kPromotion>(from, to, promo));
+            };
+
+            for (Square from : Squares::kAll) {
+                const Piece pc = board[from];
+                if (!pc || pc.colour() != us) continue;
+
+                if (pc.type() == PieceTypes::kPawn) {
+                    const i32 rank = from.rank(), file = from.file();
+                    if (!piece_at(board, rank + forward, file)) {
+                        add_pawn_move(from, Square{rank + forward, file});
+                        if (rank == startRank && !piece_at(board, rank + 2 * forward, file))
+                            candidates.push_back(Move::create<Move::Type::kNormal>(from, Square{rank + 2 * forward, file}));
+                    }
+
+                    for (i32 f : {file - 1, file + 1}) {
+                        if (f < 0 || f >= Files::kNum) continue;
+                        const Square to{rank + forward, f};
+                        if (board[to] && board[to].colour() == them) add_pawn_move(from, to);
+                        else if (to == pos.ep_square()) candidates.push_back(Move::create<Move::Type::kEnPassant>(from, to));
+                    }
+                    continue;
+                }
+
+                for (Square to : reference_attacks(board, from)) {
+                    if (!board[to] || board[to].colour() == them) candidates.push_back(Move::create<Move::Type::kNormal>(from, to));
+                }
+            }
+
+            // Castling: everything between the outermost of the king's and rook's start and end squares must be
+            // empty apart from those two pieces, and the king may not start in, pass through or land in check
+            const Square ksq = find_king(board, us);
+            for (usize side : {CastlingSides::kKingside, CastlingSides::kQueenside}) {
+                const Square rookSq = pos.castling_rook(us, side);
+                if (!rookSq) continue;
+
+                const Move move = Move::create<Move::Type::kCastling>(ksq, rookSq);
+                const Square kingTo = move.castle_king_to(), rookTo = move.castle_rook_to();
+                const i32 low = std::min({ksq.file(), rookSq.file(), kingTo.file(), rookTo.file()});
+                const i32 high = std::max({ksq.file(), rookSq.file(), kingTo.file(), rookTo.file()});
+
+                bool ok = true;
+                for (i32 f = low; f <= high; ++f) {
+                    const Square sq{ksq.rank(), f};
+                    if (sq != ksq && sq != rookSq && board[sq]) ok = false;
+                }
+
+                const i32 step = kingTo.file() >= ksq.file() ? 1 : -1;
+                for (i32 f = ksq.file(); ok; f += step) {
+                    if (!reference_attackers(board, Square{ksq.rank(), f}, them).empty()) ok = false;
+                    if (f == kingTo.file()) break;
+                }
+
+                if (ok) candidates.push_back(move);
+            }
+
+            std::vector<Move> legal;
+            for (Move move : candidates) {
+                const Board after = reference_make(board, move);
+                if (reference_attackers(after, find_king(after, us), them).empty()) legal.push_back(move);
+            }
+
+            return legal;
+        }
+
+        [[nodiscard]] std::vector<u16> sorted_raw(const auto &moves) {
+            std::vector<u16> raw;
+            for (Move move : moves) raw.push_back(move.raw());
+            std::sort(raw.begin(), raw.end());
+            return raw;
+        }
+
+        class Fuzzer {
+        public:
+            Fuzzer(u64 seed, bool withNetwork) : mPrng(seed) {
+                if (withNetwork) mAccumulators = std::make_unique<nnue::AccumulatorStack>();
+            }
+
+            // Plays one random game from pos, checking every position on the way there and back
+            void play(Position pos) {
+                if (mAccumulators) mAccumulators->reset(pos);
+
+                std::vector<BoardState> saved;
+                std::vector<std::string> savedFens;
+                const usize plies = 1 + mPrng.next_bounded(kMaxGamePlies);
+
+                for (usize ply = 0; ply < plies; ++ply) {
+                    const std::vector<Move> legal = this->check_position(pos);
+                    if (legal.empty()) break;
+
+                    saved.push_back(pos.state());
+                    savedFens.push_back(pos.to_fen());
+
+                    // Null moves now and then, as the search makes them
+                    if (!pos.in_check() && mPrng.next_bounded(16) == 0) {
+                        pos.make_null();
+                        this->check_key(pos, "after null move", Moves::kNone);
+                        continue;
+                    }
+
+                    const Move move = legal[mPrng.next_bounded(legal.size())];
+                    pos.make_move(move);
+                    this->check_key(pos, "after move", move);
+                }
+
+                while (!saved.empty()) {
+                    const bool null = pos.last_move() == Moves::kNone;
+                    const Move move = pos.last_move();
+                    if (null) pos.unmake_null();
+                    else pos.unmake_move();
+
+                    if (!(pos.state() == saved.back()) || pos.to_fen() != savedFens.back())
+                        this->fail(pos, null ? "state not restored by unmake_null" : "state not restored by unmake_move", move);
+                    this->check_accumulator(pos);
+
+                    saved.pop_back();
+                    savedFens.pop_back();
+                }
+            }
+
+            // Mutates the board of a FEN: pieces are moved, removed and added, and the side to move may change
+            [[nodiscard]] std::optional<Position> mutate(const Position &pos) {
+                const std::string fen = pos.to_fen();
+                std::string_view rest = fen;
+                const std::string_view boardField = utils::next_token(rest), stmField = utils::next_token(rest);
+                const std::string_view castlingField = utils::next_token(rest), epField = utils::next_token(rest);
+
+                utils::MDArray<char, Square::kNumTypes> squares;
+                squares.fill('.');
+                i32 rank = Ranks::k8, file = Files::kA;
+                for (char c : boardField) {
+                    if (c == '/') {
+                        rank--;
+                        file = Files::kA;
+                    } else if (c >= '1' && c <= '8') file += c - '0';
+                    else squares[Square{rank, file++}] = c;
+                }
+
+                const auto random_square = [&]() { return Square{static_cast<u8>(mPrng.next_bounded(Square::kNumTypes))}; };
+                const usize mutations = 1 + mPrng.next_bounded(3);
+                for (usize i = 0; i < mutations; ++i) {
+                    const Square a = random_square(), b = random_square();
+                    switch (mPrng.next_bounded(3)) {
+                        case 0:
+                            std::swap(squares[a], squares[b]);
+                            break;
+                        case 1:
+                            if (squares[a] != 'K' && squares[a] != 'k') squares[a] = '.';
+                            break;
+                        default:
+                            if (squares[a] == '.') squares[a] = "PNBRQpnbrq"[mPrng.next_bounded(10)];
+                            break;
+                    }
+                }
+
+                std::string board;
+                for (rank = Ranks::k8; rank >= Ranks::k1; --rank) {
+                    i32 empty = 0;
+                    for (file = Files::kA; file <= Files::kH; ++file) {
+                        const char c = squares[Square{rank, file}];
+                        if (c == '.') {
+                            empty++;
+                            continue;
+                        }
+                        if (empty) board += static_cast<char>('0' + empty);
+                        empty = 0;
+                        board += c;
+                    }
+                    if (empty) board += static_cast<char>('0' + empty);
+                    if (rank != Ranks::k1) board += '/';
+                }
+
+                const std::string stm = mPrng.next_bounded(4) == 0 ? (stmField == "w" ? "b" : "w") : std::string{stmField};
+
+                // Rights and en passant squares which no longer make sense are rejected by the parser, so fall back
+                // to positions without them
+                for (const std::string &tail : {std::string{castlingField} + " " + std::string{epField}, std::string{castlingField} + " -", std::string{"- -"}}) {
+                    if (auto mutated = Position::from_fen(board + " " + stm + " " + tail)) return mutated;
+                }
+                return std::nullopt;
+            }
+
+            [[nodiscard]] u64 positions() const {
+                return mPositions;
+            }
+
+            [[nodiscard]] u64 failures() const {
+                return mFailures;
+            }
+
+            [[nodiscard]] utils::PRNG &prng() {
+                return mPrng;
+            }
+
+        private:
+            utils::PRNG mPrng;
+            std::unique_ptr<nnue::AccumulatorStack> mAccumulators;
+            stats::Counters mStats;
+            u64 mPositions = 0;
+            u64 mFailures = 0;
+
+            void fail(const Position &pos, std::string_view what, Move move) {
+                if (mFailures++ >= kMaxReports) return;
+                std::cout << "FAIL " << what << " ; fen " << pos.to_fen();
+                if (move != Moves::kNone) std::cout << " ; move " << move.to_str<true>();
+                std::cout << std::endl;
+            }
+
+            void check_key(const Position &pos, std::string_view when, Move move) {
+                if (pos.key() != pos.compute_key()) {
+                    this->fail(pos, std::string{"incremental key differs from computed key "} + std::string{when}, move);
+                }
+            }
+
+            void check_accumulator(const Position &pos) {
+                if (mAccumulators && mAccumulators->evaluate(pos, mStats) != nnue::evaluate(pos))
+                    this->fail(pos, "incremental accumulator differs from refreshed one", pos.last_move());
+            }
+
+            // Returns the legal moves, after checking them and everything else about the position
+            std::vector<Move> check_position(const Position &pos) {
+                mPositions++;
+                this->check_key(pos, "", Moves::kNone);
+                this->check_accumulator(pos);
+
+                Board board;
+                for (Square sq : Squares::kAll) board[sq] = pos.piece_on(sq);
+                if (pos.checkers() != reference_attackers(board, pos.king_sq(pos.stm()), pos.stm().flip()))
+                    this->fail(pos, "checkers differ from reference", Moves::kNone);
+
+                MoveList generated;
+                movegen::generate_legal(pos, generated);
+                const std::vector<Move> reference = reference_moves(pos);
+                const std::vector<u16> generatedRaw = sorted_raw(generated), referenceRaw = sorted_raw(reference);
+
+                if (generatedRaw != referenceRaw) {
+                    this->fail(pos, "legal moves differ from reference (" + std::to_string(generated.size()) + " generated, "
+                                    + std::to_string(reference.size()) + " expected)", Moves::kNone);
+                }
+
+                // Check generation must find exactly the legal moves after which the enemy king is attacked
+                std::vector<Move> referenceChecks, referenceQuietChecks;
+                for (Move move : reference) {
+                    const Board after = reference_make(board, move);
+                    if (reference_attackers(after, find_king(after, pos.stm().flip()), pos.stm()).empty()) continue;
+
+                    referenceChecks.push_back(move);
+                    if (!pos.is_noisy(move)) referenceQuietChecks.push_back(move);
+                }
+
+                const auto legal_only = [&](const MoveList &moves) {
+                    MoveList legal;
+                    for (Move move : moves) {
+                        if (pos.is_legal(move)) legal.push(move);
+                    }
+                    return sorted_raw(legal);
+                };
+
+                MoveList checks, quietChecks;
+                movegen::generate<movegen::GenType::kChecks>(pos, checks);
+                movegen::generate<movegen::GenType::kQuietChecks>(pos, quietChecks);
+                if (legal_only(checks) != sorted_raw(referenceChecks))
+                    this->fail(pos, "checking moves differ from reference", Moves::kNone);
+                if (legal_only(quietChecks) != sorted_raw(referenceQuietChecks))
+                    this->fail(pos, "quiet checking moves differ from reference", Moves::kNone);
+
+                // Validation of moves from the TT or killers must accept exactly the legal moves
+                const auto accepted = [&](Move move) { return pos.is_pseudo_legal(move) && pos.is_legal(move); };
+                for (Move move : reference) {
+                    if (!accepted(move)) this->fail(pos, "legal move rejected by is_pseudo_legal/is_legal", move);
+                }
+                for (usize i = 0; i < kRandomMoves; ++i) {
+                    const Move move{static_cast<u16>(mPrng.next())};
+                    const bool legal = std::binary_search(referenceRaw.begin(), referenceRaw.end(), move.raw());
+                    if (accepted(move) != legal) this->fail(pos, "is_pseudo_legal/is_legal disagree with reference", move);
+                }
+
+                return reference;
+            }
+        };
+
+        bool parse_options(i32 argc, char *argv[], Options &options) {
+            for (i32 i = 2; i < argc; ++i) {
+                const std::string_view flag = argv[i];
+                if (i + 1 >= argc) {
+                    std::cerr << "Missing value for " << flag << std::endl;
+                    return false;
+                }
+
+                const std::string_view value = argv[++i];
+                bool ok = true;
+
+                if (flag == "--games") {
+                    const auto games = utils::parse_int<u64>(value);
+                    ok = games.has_value();
+                    if (ok) options.games = *games;
+                } else if (flag == "--seed") {
+                    const auto seed = utils::parse_int<u64>(value);
+                    ok = seed.has_value();
+                    if (ok) options.seed = *seed;
+                } else if (flag == "--net") options.net = value;
+                else {
+                    std::cerr << "Unknown option " << flag << std::endl;
+                    return false;
+                }
+
+                if (!ok) {
+                    std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    i32 run(i32 argc, char *argv[]) {
+        Options options;
+        if (!parse_options(argc, argv, options)) return 1;
+
+        if (!options.net.empty() && !nnue::load(options.net)) {
+            std::cerr << "Could not load network " << options.net << std::endl;
+            return 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        Fuzzer fuzzer{options.seed, nnue::loaded()};
+        u64 mutatedGames = 0;
+
+        // Alternate between games from the bench positions and from mutations of wherever the last game began
+        Position mutationBase = Position::startpos();
+        for (u64 game = 0; game < options.games; ++game) {
+            if (game % 2 == 0) {
+                mutationBase = *Position::from_fen(bench::kFens[fuzzer.prng().next_bounded(bench::kFens.size())]);
+                fuzzer.play(mutationBase);
+            } else if (const auto mutated = fuzzer.mutate(mutationBase)) {
+                mutatedGames++;
+                fuzzer.play(*mutated);
+            }
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Checked " << fuzzer.positions() << " positions in " << options.games << " games (" << mutatedGames
+                  << " from mutated FENs) in " << elapsed << " ms" << (nnue::loaded() ? ", with the network" : "")
+                  << ": " << fuzzer.failures() << " failures" << std::endl;
+
+        return fuzzer.failures() ? 1 : 0;
+    }
+}
@@ -0,0 +1,32 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+// Differential fuzzing of the board code: `Purebred fuzz [--games N] [--seed S] [--net <file>]`
+// Plays random games from the bench positions and from randomly mutated FENs. At every position it compares
+// move generation and TT move validation against a slow reference generator built on the runtime slider
+// attacks, and checks that incremental keys match recomputed ones and that unmaking restores every state
+// exactly. With a network, incrementally updated accumulators are also compared with refreshed ones.
+namespace purebred::fuzz {
+
+    // Returns the process exit code, which is nonzero if any check failed.
+    [[nodiscard]] i32 run(i32 argc, char *argv[]);
+}
@@ -16,16 +16,42 @@
  * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "analyse.h"
 #include "attacks.h"
+#include "bench.h"
 #include "core.h"
+#include "cuckoo.h"
+#include "datagen.h"
+#include "dataprep.h"
+#include "evalbatch.h"
+#include "fuzz.h"
+#include "perft.h"
+#include "trace.h"
 #include "types.h"
+#include "uci.h"
 
 #include <iostream>
+#include <string_view>
 
 using namespace purebred;
 
 i32 main(i32 argc, char* argv[]) {
 
     attacks::init();
+    cuckoo::init();
+
+    if (argc > 1) {
+        const std::string_view mode = argv[1];
+        if (mode == "bench") return bench::run(argc, argv);
+        if (mode == "perft") return run_perft_suite();
+        if (mode == "analyse") return analyse::run(argc, argv);
+        if (mode == "datagen") return datagen::run(argc, argv);
+        if (mode == "dataprep") return dataprep::run(argc, argv);
+        if (mode == "evalbatch") return evalbatch::run(argc, argv);
+        if (mode == "trace") return trace::run(argc, argv);
+        if (mode == "fuzz") return fuzz::run(argc, argv);
+    }
+
     std::cout << kName << " by " << kAuthor << std::endl;
+    uci::loop();
 }
\ No newline at end of file
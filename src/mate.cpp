@@ -0,0 +1,268 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mate.h"
+
+#include "movegen.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace purebred::mate {
+
+    namespace {
+        constexpr u32 kInfinity = u32{1} << 30;
+
+        [[nodiscard]] u32 saturating_add(u32 a, u32 b) {
+            return std::min(a + b, kInfinity);
+        }
+
+        // The legal moves which the side to move may play in the proof tree: checks for the attacker, anything
+        // for the defender
+        void generate_tree_moves(const Position &pos, bool attacker, MoveList &moves) {
+            if (!attacker) {
+                movegen::generate_legal(pos, moves);
+                return;
+            }
+
+            MoveList checks;
+            movegen::generate<movegen::GenType::kChecks>(pos, checks);
+            for (Move move : checks) {
+                if (pos.is_legal(move)) moves.push(move);
+            }
+        }
+    }
+
+    Solver::Solver(std::atomic<bool> &stop, usize megabytes) : mStop(stop) {
+        // A power of two, so that the index is a mask of the key
+        mTable.resize(std::bit_floor(std::max<usize>(megabytes * 1024 * 1024 / sizeof(Entry), 1)));
+    }
+
+    void Solver::clear() {
+        std::fill(mTable.begin(), mTable.end(), Entry{});
+    }
+
+    Result Solver::solve(const Position &pos, const search::Limits &limits) {
+        mPos = pos;
+        mPos.reserve(kMaxPly + 1);
+        mAttacker = pos.stm();
+        mLimits = limits;
+        mTime.start(limits, pos.stm());
+        mNodes = 0;
+        mNextTimeCheck = 0;
+        mExhausted = false;
+
+        Result result;
+        const i32 maxMoves = std::clamp(limits.mate, 0, static_cast<i32>(kMaxPly / 2));
+
+        // A proof of mate within the limit is followed by searches for shorter mates, so that the reported line
+        // is the shortest one, with the longest defence
+        if (this->prove(2 * maxMoves - 1)) {
+            result.moves = this->shortest_mate(maxMoves);
+            if (result.moves) this->extract_line(result.moves, result.pv);
+
+            // The line is only useful if it got as far as the first move before being interrupted
+            if (result.pv.empty()) result.moves = 0;
+        }
+
+        result.nodes = mNodes;
+        return result;
+    }
+
+    bool Solver::should_stop() {
+        if (mExhausted || mStop.load(std::memory_order_relaxed)) return true;
+        if (mLimits.nodes && mNodes >= mLimits.nodes) {
+            mExhausted = true;
+            return true;
+        }
+        if (mNodes < mNextTimeCheck) return false;
+
+        mNextTimeCheck = mNodes + 1024;
+        mExhausted = mTime.hard_expired();
+        return mExhausted;
+    }
+
+    u64 Solver::table_key(u64 key, i32 plies) {
+        // A proof with more plies to spare does not hold with fewer, so the depth is part of the key
+        return key ^ (static_cast<u64>(plies) * U64C(0x9E3779B97F4A7C15));
+    }
+
+    const Solver::Entry *Solver::probe(u64 key, i32 plies) const {
+        const u64 tableKey = table_key(key, plies);
+        const Entry &entry = mTable[tableKey & (mTable.size() - 1)];
+        return entry.key == tableKey ? &entry : nullptr;
+    }
+
+    void Solver::store(u64 key, i32 plies, Numbers numbers) {
+        const u64 tableKey = table_key(key, plies);
+        Entry &entry = mTable[tableKey & (mTable.size() - 1)];
+
+        // Solved nodes are worth more than any amount of unfinished work on another position
+        if (entry.key != tableKey && entry.numbers.solved() && !numbers.solved()) return;
+
+        entry = {tableKey, numbers};
+    }
+
+    bool Solver::prove(i32 plies) {
+        const Numbers numbers = this->mid(plies, kInfinity - 1, kInfinity - 1);
+
+        // phi is zero when the side to move wins: at the attacker's nodes that is a mate, at the defender's an escape
+        return mPos.stm() == mAttacker ? numbers.phi == 0 : numbers.delta == 0;
+    }
+
+    // Each node stores phi and delta from the point of view of its side to move: phi is the proof number of a win
+    // for that side and delta the proof number of a loss. A node's phi is the smallest delta of its children, and
+    // its delta is the sum of their phis. The most promising child is searched until it is solved or its numbers
+    // pass the thresholds under which it stays the most promising.
+    Solver::Numbers Solver::mid(i32 plies, u32 thresholdPhi, u32 thresholdDelta) {
+        mNodes++;
+        const bool attacker = mPos.stm() == mAttacker;
+        const u64 key = mPos.key();
+
+        MoveList moves;
+        generate_tree_moves(mPos, attacker, moves);
+
+        // The attacker has run out of checks, or the defender out of moves (mated, as the defender is always in
+        // check) or out of time to be mated in
+        if (moves.empty() || (!attacker && plies == 0)) {
+            const bool sideToMoveWins = !attacker && !moves.empty();
+            const Numbers numbers = sideToMoveWins ? Numbers{0, kInfinity} : Numbers{kInfinity, 0};
+            this->store(key, plies, numbers);
+            return numbers;
+        }
+
+        // Children start with numbers favouring checks which leave the defender few replies
+        utils::ArrayVec<Child, kMaxMoves> children;
+        for (Move move : moves) {
+            mPos.make_move(move);
+            Child child{move, mPos.key(), {1, 1}};
+            if (attacker) {
+                MoveList replies;
+                generate_tree_moves(mPos, false, replies);
+
+                const u32 count = static_cast<u32>(replies.size());
+                if (count == 0) child.numbers = {kInfinity, 0};
+                else if (plies == 1) child.numbers = {0, kInfinity};
+                else child.numbers.delta = count;
+            }
+            mPos.unmake_move();
+            children.push(child);
+        }
+
+        // The children's own numbers are kept up to date here as well as in the table, where they may be overwritten
+        for (Child &child : children) {
+            if (const Entry *entry = this->probe(child.key, plies - 1)) child.numbers = entry->numbers;
+        }
+
+        while (true) {
+            u32 phi = kInfinity, delta = 0;
+            usize best = 0;
+            u32 bestDelta = kInfinity, secondDelta = kInfinity;
+
+            for (usize i = 0; i < children.size(); ++i) {
+                const u32 childPhi = children[i].numbers.phi;
+                const u32 childDelta = children[i].numbers.delta;
+
+                phi = std::min(phi, childDelta);
+                delta = saturating_add(delta, childPhi);
+
+                if (childDelta < bestDelta) {
+                    secondDelta = bestDelta;
+                    bestDelta = childDelta;
+                    best = i;
+                } else if (childDelta < secondDelta) {
+                    secondDelta = childDelta;
+                }
+            }
+
+            if (phi >= thresholdPhi || delta >= thresholdDelta || this->should_stop()) {
+                this->store(key, plies, {phi, delta});
+                return {phi, delta};
+            }
+
+            const u32 bestPhi = children[best].numbers.phi;
+
+            // Searching a child a little past its sibling's number (1 + epsilon) saves a lot of switching back and forth
+            const u32 childThresholdPhi = saturating_add(thresholdDelta - delta, bestPhi);
+            const u32 childThresholdDelta = std::min(thresholdPhi, saturating_add(secondDelta, secondDelta / 4 + 1));
+
+            mPos.make_move(children[best].move);
+            children[best].numbers = this->mid(plies - 1, childThresholdPhi, childThresholdDelta);
+            mPos.unmake_move();
+        }
+    }
+
+    i32 Solver::shortest_mate(i32 maxMoves) {
+        for (i32 moves = 1; moves <= maxMoves; ++moves) {
+            if (this->prove(2 * moves - 1)) return moves;
+            if (this->should_stop()) return 0;
+        }
+        return 0;
+    }
+
+    void Solver::extract_line(i32 moves, search::PVLine &line) {
+        MoveList checks;
+        generate_tree_moves(mPos, true, checks);
+
+        // Any check after which the defender is mated within the remaining moves continues the line
+        Move mating = Moves::kNone;
+        for (Move move : checks) {
+            mPos.make_move(move);
+            const bool proven = this->prove(2 * moves - 2);
+            mPos.unmake_move();
+
+            if (proven) {
+                mating = move;
+                break;
+            }
+            if (this->should_stop()) return;
+        }
+
+        if (mating == Moves::kNone) return;
+        line.push(mating);
+        if (moves == 1) return;
+
+        mPos.make_move(mating);
+
+        // The defence is the reply which postpones mate the longest
+        MoveList replies;
+        movegen::generate_legal(mPos, replies);
+        Move defence = Moves::kNone;
+        i32 longest = 0;
+        for (Move reply : replies) {
+            mPos.make_move(reply);
+            const i32 length = this->shortest_mate(moves - 1);
+            mPos.unmake_move();
+
+            if (length > longest) {
+                longest = length;
+                defence = reply;
+            }
+            if (this->should_stop()) break;
+        }
+
+        if (defence != Moves::kNone && !this->should_stop()) {
+            line.push(defence);
+            mPos.make_move(defence);
+            this->extract_line(longest, line);
+            mPos.unmake_move();
+        }
+
+        mPos.unmake_move();
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "move.h"
+#include "position.h"
+#include "search.h"
+#include "types.h"
+
+#include <atomic>
+#include <vector>
+
+// A dedicated solver for `go mate N`: depth-first proof-number search (df-pn) over the tree in which the side
+// to move only plays checks and the defender plays everything, with its own table of proof and disproof numbers.
+// Proof numbers steer the search towards the lines with the fewest defensive replies, which finds forced mates
+// far deeper than alpha-beta with mate scores can in the same time.
+namespace purebred::mate {
+
+    struct Result {
+        // Length of the mate in moves, or 0 if none was found
+        i32 moves = 0;
+        search::PVLine pv;
+        u64 nodes = 0;
+    };
+
+    class Solver {
+    public:
+        // The table takes about `megabytes`; what it proves stays valid from one search to the next
+        Solver(std::atomic<bool> &stop, usize megabytes);
+
+        // Looks for the shortest mate in at most limits.mate moves, within the node and time limits. Running out
+        // of either only ends this search, while `stop` is left for the caller to set.
+        [[nodiscard]] Result solve(const Position &pos, const search::Limits &limits);
+
+        void clear();
+
+    private:
+        // Proof and disproof numbers, from the point of view of the side to move
+        struct Numbers {
+            u32 phi = 0;
+            u32 delta = 0;
+
+            [[nodiscard]] bool solved() const {
+                return phi == 0 || delta == 0;
+            }
+
+            [[nodiscard]] bool operator==(const Numbers &) const = default;
+        };
+
+        struct Entry {
+            u64 key = 0;
+            Numbers numbers;
+        };
+
+        // One move from a node being expanded, with its child's key and the numbers to use until it is searched
+        struct Child {
+            Move move;
+            u64 key;
+            Numbers numbers;
+
+            [[nodiscard]] bool operator==(const Child &) const = default;
+        };
+
+        std::atomic<bool> &mStop;
+        std::vector<Entry> mTable;
+        Position mPos;
+        Colour mAttacker;
+        search::Limits mLimits;
+        search::TimeManager mTime;
+        u64 mNodes = 0;
+        u64 mNextTimeCheck = 0;
+        bool mExhausted = false;
+
+        [[nodiscard]] bool should_stop();
+
+        [[nodiscard]] static u64 table_key(u64 key, i32 plies);
+        [[nodiscard]] const Entry *probe(u64 key, i32 plies) const;
+        void store(u64 key, i32 plies, Numbers numbers);
+
+        // Whether the side to move can be mated (at the defender's nodes) or can mate (at the attacker's) within
+        // the given number of plies, which must be odd at the attacker's nodes
+        [[nodiscard]] bool prove(i32 plies);
+        [[nodiscard]] Numbers mid(i32 plies, u32 thresholdPhi, u32 thresholdDelta);
+        [[nodiscard]] i32 shortest_mate(i32 maxMoves);
+        void extract_line(i32 moves, search::PVLine &line);
+    };
+}
@@ -87,6 +87,11 @@ namespace purebred {
             return PieceType{(mData >> kPromoShift) + PieceTypes::kKnight.raw()};
         }
 
+        // Only promotions carry promotion bits, so anything else was not produced by move generation.
+        [[nodiscard]] constexpr bool is_canonical() const {
+            return this->type() == Type::kPromotion || !(mData >> kPromoShift);
+        }
+
         [[nodiscard]] constexpr bool castle_is_kingside() const {
             assert(this->type() == Type::kCastling);
             return this->to().raw() > this->from().raw();
@@ -102,20 +107,38 @@ namespace purebred {
             return Square{this->from().rank(), this->castle_is_kingside() ? Files::kF : Files::kD};
         }
 
+        // The longest a move can be in UCI notation, which is a promotion
+        static constexpr usize kMaxStrSize = 5;
+
+        // Writes the move in UCI notation and returns the end of what was written
         template <bool kChess960>
-        [[nodiscard]] constexpr std::string to_str() const {
-            std::string s;
-            s += this->from().to_str();
+        constexpr char *write(char *out) const {
+            out = this->from().write(out);
 
             if (!kChess960 && this->type() == Type::kCastling)
-                s += this->castle_king_to().to_str();
+                out = this->castle_king_to().write(out);
             else
-                s += this->to().to_str();
+                out = this->to().write(out);
 
             if (this->type() == Type::kPromotion)
-                s += this->promo_type().to_char();
+                *out++ = this->promo_type().to_char();
+
+            return out;
+        }
 
-            return s;
+        constexpr char *write(char *out, bool chess960) const {
+            return chess960 ? this->write<true>(out) : this->write<false>(out);
+        }
+
+        [[nodiscard]] constexpr std::string to_str(bool chess960) const {
+            utils::MDArray<char, kMaxStrSize> str;
+            return std::string(str.data(), this->write(str.data(), chess960));
+        }
+
+        template <bool kChess960>
+        [[nodiscard]] constexpr std::string to_str() const {
+            utils::MDArray<char, kMaxStrSize> str;
+            return std::string(str.data(), this->write<kChess960>(str.data()));
         }
 
     private:
@@ -0,0 +1,331 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "movegen.h"
+
+#include "attacks.h"
+#include "position.h"
+
+namespace purebred::movegen {
+
+    namespace {
+        template <Move::Type kMoveType>
+        void push_all(MoveList &moves, Bitboard targets, i32 offset) {
+            for (Square to : targets) moves.push(Move::create<kMoveType>(Square{to.raw() - offset}, to));
+        }
+
+        template <GenType kType>
+        void push_promotions(MoveList &moves, Square from, Square to) {
+            // Queen promotions are noisy regardless of whether they capture, while underpromotions are always quiet
+            if constexpr (kType != GenType::kQuiet)
+                moves.push(Move::create<Move::Type::kPromotion>(from, to, PieceTypes::kQueen));
+
+            if constexpr (kType != GenType::kNoisy) {
+                moves.push(Move::create<Move::Type::kPromotion>(from, to, PieceTypes::kKnight));
+                moves.push(Move::create<Move::Type::kPromotion>(from, to, PieceTypes::kRook));
+                moves.push(Move::create<Move::Type::kPromotion>(from, to, PieceTypes::kBishop));
+            }
+        }
+
+        template <GenType kType, Direction kUp>
+        void generate_pawn_moves(const Position &pos, MoveList &moves) {
+            constexpr Direction kUpLeft = kUp + Direction::kLeft;
+            constexpr Direction kUpRight = kUp + Direction::kRight;
+            constexpr i32 kUpOffset = static_cast<i32>(kUp);
+            constexpr i32 kUpLeftOffset = static_cast<i32>(kUpLeft);
+            constexpr i32 kUpRightOffset = static_cast<i32>(kUpRight);
+
+            const Colour us = pos.stm(), them = us.flip();
+            const Bitboard empty = ~pos.pieces();
+            const Bitboard enemies = pos.pieces(them);
+            const Bitboard pawns = pos.pieces(us, PieceTypes::kPawn);
+
+            const Bitboard promoRank = us == Colours::kWhite ? Bitboards::kRank8 : Bitboards::kRank1;
+            const Bitboard doublePushRank = us == Colours::kWhite ? Bitboards::kRank4 : Bitboards::kRank5;
+
+            const Bitboard pushes = pawns.shift<kUp>() & empty;
+            const Bitboard leftCaptures = pawns.shift<kUpLeft>() & enemies;
+            const Bitboard rightCaptures = pawns.shift<kUpRight>() & enemies;
+
+            if constexpr (kType != GenType::kQuiet) {
+                push_all<Move::Type::kNormal>(moves, leftCaptures & ~promoRank, kUpLeftOffset);
+                push_all<Move::Type::kNormal>(moves, rightCaptures & ~promoRank, kUpRightOffset);
+
+                if (pos.ep_square()) {
+                    const Bitboard epBB = Bitboard{pos.ep_square()};
+                    push_all<Move::Type::kEnPassant>(moves, pawns.shift<kUpLeft>() & epBB, kUpLeftOffset);
+                    push_all<Move::Type::kEnPassant>(moves, pawns.shift<kUpRight>() & epBB, kUpRightOffset);
+                }
+            }
+
+            if constexpr (kType != GenType::kNoisy) {
+                const Bitboard doublePushes = (pushes & ~promoRank).shift<kUp>() & empty & doublePushRank;
+                push_all<Move::Type::kNormal>(moves, pushes & ~promoRank, kUpOffset);
+                push_all<Move::Type::kNormal>(moves, doublePushes, kUpOffset * 2);
+            }
+
+            for (Square to : pushes & promoRank)
+                push_promotions<kType>(moves, Square{to.raw() - kUpOffset}, to);
+            for (Square to : leftCaptures & promoRank)
+                push_promotions<kType>(moves, Square{to.raw() - kUpLeftOffset}, to);
+            for (Square to : rightCaptures & promoRank)
+                push_promotions<kType>(moves, Square{to.raw() - kUpRightOffset}, to);
+        }
+
+        template <Bitboard (*kAttacks)(Square, Bitboard)>
+        void generate_piece_moves(MoveList &moves, Bitboard pieces, Bitboard targets, Bitboard occ) {
+            for (Square from : pieces) {
+                for (Square to : kAttacks(from, occ) & targets) moves.push(Move::create<Move::Type::kNormal>(from, to));
+            }
+        }
+
+        void generate_castling(const Position &pos, MoveList &moves) {
+            const Colour us = pos.stm();
+            const Square ksq = pos.king_sq(us);
+
+            for (usize side = 0; side < CastlingSides::kNum; ++side) {
+                const Square rookSq = pos.castling_rook(us, side);
+                if (!rookSq) continue;
+
+                const Move move = Move::create<Move::Type::kCastling>(ksq, rookSq);
+                if (pos.castling_path_clear(move)) moves.push(move);
+            }
+        }
+
+        // What a move has to do to give check, computed once per node: put a piece of its type on one of the
+        // squares from which that type attacks the enemy king, or move a piece which stands between the king and
+        // one of our sliders off their line
+        struct CheckInfo {
+            Square king;
+            utils::MDArray<Bitboard, PieceType::kNumTypes> squares;
+            Bitboard discoverers = Bitboards::kEmpty;
+
+            explicit CheckInfo(const Position &pos) : king(pos.king_sq(pos.stm().flip())) {
+                const Colour us = pos.stm();
+                const Bitboard occ = pos.pieces();
+
+                squares.fill(Bitboards::kEmpty);
+                squares[PieceTypes::kPawn] = attacks::get_pawn_attacks(us.flip(), king);
+                squares[PieceTypes::kKnight] = attacks::get_knight_attacks(king);
+                squares[PieceTypes::kBishop] = attacks::get_bishop_attacks(king, occ);
+                squares[PieceTypes::kRook] = attacks::get_rook_attacks(king, occ);
+                squares[PieceTypes::kQueen] = squares[PieceTypes::kBishop] | squares[PieceTypes::kRook];
+
+                const Bitboard snipers = (attacks::get_bishop_attacks(king) & pos.diagonal_sliders(us))
+                                       | (attacks::get_rook_attacks(king) & pos.orthogonal_sliders(us));
+                for (Square sniper : snipers) {
+                    const Bitboard between = attacks::betweenBB[king][sniper] & occ;
+                    if (between.one_bit_set() && (between & pos.pieces(us))) discoverers |= between;
+                }
+            }
+
+            // The destinations from which a piece of this type standing on `from` gives check
+            [[nodiscard]] Bitboard targets(PieceType pt, Square from) const {
+                if (discoverers.get_bit(from)) return squares[pt] | ~attacks::lineBB[king][from];
+                return squares[pt];
+            }
+        };
+
+        // Promotions, en passant and castling change more of the board than the check squares account for, so
+        // they are tested by looking at the enemy king's surroundings after the move
+        [[nodiscard]] bool special_gives_check(const Position &pos, const CheckInfo &info, Move move) {
+            const Colour us = pos.stm();
+            const Square from = move.from(), to = move.to();
+
+            Bitboard occ = pos.pieces() ^ Bitboard{from};
+            Bitboard diagonal = pos.diagonal_sliders(us);
+            Bitboard orthogonal = pos.orthogonal_sliders(us);
+            Bitboard direct = Bitboards::kEmpty;
+
+            switch (move.type()) {
+                case Move::Type::kPromotion: {
+                    const PieceType promo = move.promo_type();
+                    occ |= Bitboard{to};
+                    if (promo == PieceTypes::kKnight) direct = attacks::get_knight_attacks(to);
+                    if (promo == PieceTypes::kBishop || promo == PieceTypes::kQueen) diagonal |= Bitboard{to};
+                    if (promo == PieceTypes::kRook || promo == PieceTypes::kQueen) orthogonal |= Bitboard{to};
+                    break;
+                }
+
+                case Move::Type::kEnPassant:
+                    occ = (occ ^ Bitboard{Square{from.rank(), to.file()}}) | Bitboard{to};
+                    direct = attacks::get_pawn_attacks(us, to);
+                    break;
+
+                case Move::Type::kCastling:
+                    occ = (occ ^ Bitboard{to}) | Bitboard{move.castle_king_to()} | Bitboard{move.castle_rook_to()};
+                    orthogonal = (orthogonal ^ Bitboard{to}) | Bitboard{move.castle_rook_to()};
+                    break;
+
+                default:
+                    break;
+            }
+
+            return direct.get_bit(info.king)
+                || !(attacks::get_bishop_attacks(info.king, occ) & diagonal).empty()
+                || !(attacks::get_rook_attacks(info.king, occ) & orthogonal).empty();
+        }
+
+        template <GenType kType>
+        void push_promotion_checks(const Position &pos, const CheckInfo &info, MoveList &moves, Square from, Square to) {
+            constexpr bool kQueens = kType == GenType::kChecks;
+            for (PieceType promo : {PieceTypes::kQueen, PieceTypes::kKnight, PieceTypes::kRook, PieceTypes::kBishop}) {
+                if (promo == PieceTypes::kQueen && !kQueens) continue;
+
+                const Move move = Move::create<Move::Type::kPromotion>(from, to, promo);
+                if (special_gives_check(pos, info, move)) moves.push(move);
+            }
+        }
+
+        template <GenType kType, Direction kUp>
+        void generate_pawn_checks(const Position &pos, const CheckInfo &info, MoveList &moves) {
+            constexpr Direction kUpLeft = kUp + Direction::kLeft;
+            constexpr Direction kUpRight = kUp + Direction::kRight;
+            constexpr i32 kUpOffset = static_cast<i32>(kUp);
+            constexpr i32 kUpLeftOffset = static_cast<i32>(kUpLeft);
+            constexpr i32 kUpRightOffset = static_cast<i32>(kUpRight);
+
+            const Colour us = pos.stm(), them = us.flip();
+            const Bitboard empty = ~pos.pieces();
+            const Bitboard enemies = pos.pieces(them);
+            const Bitboard pawns = pos.pieces(us, PieceTypes::kPawn);
+
+            const Bitboard promoRank = us == Colours::kWhite ? Bitboards::kRank8 : Bitboards::kRank1;
+            const Bitboard doublePushRank = us == Colours::kWhite ? Bitboards::kRank4 : Bitboards::kRank5;
+
+            // Pawns which discover check do so wherever they go off the line, so they get their own targets
+            const auto push_checks = [&](Bitboard group, Bitboard targets) {
+                const Bitboard pushes = group.shift<kUp>() & empty & ~promoRank;
+                const Bitboard doublePushes = pushes.shift<kUp>() & empty & doublePushRank;
+                push_all<Move::Type::kNormal>(moves, pushes & targets, kUpOffset);
+                push_all<Move::Type::kNormal>(moves, doublePushes & targets, kUpOffset * 2);
+
+                if constexpr (kType == GenType::kChecks) {
+                    push_all<Move::Type::kNormal>(moves, group.shift<kUpLeft>() & enemies & ~promoRank & targets, kUpLeftOffset);
+                    push_all<Move::Type::kNormal>(moves, group.shift<kUpRight>() & enemies & ~promoRank & targets, kUpRightOffset);
+                }
+            };
+
+            push_checks(pawns & ~info.discoverers, info.squares[PieceTypes::kPawn]);
+            for (Square from : pawns & info.discoverers) push_checks(Bitboard{from}, info.targets(PieceTypes::kPawn, from));
+
+            for (Square to : pawns.shift<kUp>() & empty & promoRank)
+                push_promotion_checks<kType>(pos, info, moves, Square{to.raw() - kUpOffset}, to);
+
+            if constexpr (kType == GenType::kChecks) {
+                for (Square to : pawns.shift<kUpLeft>() & enemies & promoRank)
+                    push_promotion_checks<kType>(pos, info, moves, Square{to.raw() - kUpLeftOffset}, to);
+                for (Square to : pawns.shift<kUpRight>() & enemies & promoRank)
+                    push_promotion_checks<kType>(pos, info, moves, Square{to.raw() - kUpRightOffset}, to);
+
+                if (pos.ep_square()) {
+                    for (Square from : attacks::get_pawn_attacks(them, pos.ep_square()) & pawns) {
+                        const Move move = Move::create<Move::Type::kEnPassant>(from, pos.ep_square());
+                        if (special_gives_check(pos, info, move)) moves.push(move);
+                    }
+                }
+            }
+        }
+
+        template <Bitboard (*kAttacks)(Square, Bitboard)>
+        void generate_piece_checks(const Position &pos, const CheckInfo &info, MoveList &moves, PieceType pt, Bitboard allowed) {
+            const Bitboard occ = pos.pieces();
+            for (Square from : pos.pieces(pos.stm(), pt)) {
+                for (Square to : kAttacks(from, occ) & allowed & info.targets(pt, from))
+                    moves.push(Move::create<Move::Type::kNormal>(from, to));
+            }
+        }
+
+        template <GenType kType>
+        void generate_checks(const Position &pos, MoveList &moves) {
+            const CheckInfo info{pos};
+            const Colour us = pos.stm();
+
+            // Quiet checks land on empty squares, the rest may also capture
+            const Bitboard allowed = kType == GenType::kQuietChecks ? ~pos.pieces() : ~pos.pieces(us);
+
+            if (us == Colours::kWhite) generate_pawn_checks<kType, Direction::kUp>(pos, info, moves);
+            else generate_pawn_checks<kType, Direction::kDown>(pos, info, moves);
+
+            generate_piece_checks<attacks::get_knight_attacks>(pos, info, moves, PieceTypes::kKnight, allowed);
+            generate_piece_checks<attacks::get_bishop_attacks>(pos, info, moves, PieceTypes::kBishop, allowed);
+            generate_piece_checks<attacks::get_rook_attacks>(pos, info, moves, PieceTypes::kRook, allowed);
+            generate_piece_checks<attacks::get_queen_attacks>(pos, info, moves, PieceTypes::kQueen, allowed);
+            generate_piece_checks<attacks::get_king_attacks>(pos, info, moves, PieceTypes::kKing, allowed);
+
+            if (pos.in_check()) return;
+
+            const Square ksq = pos.king_sq(us);
+            for (usize side = 0; side < CastlingSides::kNum; ++side) {
+                const Square rookSq = pos.castling_rook(us, side);
+                if (!rookSq) continue;
+
+                const Move move = Move::create<Move::Type::kCastling>(ksq, rookSq);
+                if (pos.castling_path_clear(move) && special_gives_check(pos, info, move)) moves.push(move);
+            }
+        }
+    }
+
+    template <GenType kType>
+    void generate(const Position &pos, MoveList &moves) {
+        if constexpr (kType == GenType::kQuietChecks || kType == GenType::kChecks) {
+            generate_checks<kType>(pos, moves);
+            return;
+        }
+
+        const Colour us = pos.stm(), them = us.flip();
+        const Bitboard occ = pos.pieces();
+
+        const Bitboard targets = [&]() {
+            switch (kType) {
+                case GenType::kNoisy: return pos.pieces(them);
+                case GenType::kQuiet: return ~occ;
+                default: return ~pos.pieces(us);
+            }
+        }();
+
+        if (us == Colours::kWhite) generate_pawn_moves<kType, Direction::kUp>(pos, moves);
+        else generate_pawn_moves<kType, Direction::kDown>(pos, moves);
+
+        generate_piece_moves<attacks::get_knight_attacks>(moves, pos.pieces(us, PieceTypes::kKnight), targets, occ);
+        generate_piece_moves<attacks::get_bishop_attacks>(moves, pos.pieces(us, PieceTypes::kBishop), targets, occ);
+        generate_piece_moves<attacks::get_rook_attacks>(moves, pos.pieces(us, PieceTypes::kRook), targets, occ);
+        generate_piece_moves<attacks::get_queen_attacks>(moves, pos.pieces(us, PieceTypes::kQueen), targets, occ);
+        generate_piece_moves<attacks::get_king_attacks>(moves, pos.pieces(us, PieceTypes::kKing), targets, occ);
+
+        if constexpr (kType != GenType::kNoisy) {
+            if (!pos.in_check()) generate_castling(pos, moves);
+        }
+    }
+
+    template void generate<GenType::kNoisy>(const Position &, MoveList &);
+    template void generate<GenType::kQuiet>(const Position &, MoveList &);
+    template void generate<GenType::kAll>(const Position &, MoveList &);
+    template void generate<GenType::kQuietChecks>(const Position &, MoveList &);
+    template void generate<GenType::kChecks>(const Position &, MoveList &);
+
+    void generate_legal(const Position &pos, MoveList &moves) {
+        MoveList pseudo;
+        generate<GenType::kAll>(pos, pseudo);
+
+        for (Move move : pseudo) {
+            if (pos.is_legal(move)) moves.push(move);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "core.h"
+#include "move.h"
+#include "types.h"
+#include "utils/arrayvec.h"
+
+namespace purebred {
+
+    class Position;
+
+    using MoveList = utils::ArrayVec<Move, kMaxMoves>;
+
+    namespace movegen {
+
+        // Noisy moves are captures and queen promotions; everything else (including underpromotions) is quiet.
+        // The check types only produce moves which give check, directly or by discovery: kQuietChecks the quiet
+        // ones and kChecks all of them.
+        enum class GenType {
+            kNoisy,
+            kQuiet,
+            kAll,
+            kQuietChecks,
+            kChecks
+        };
+
+        // Generates pseudo-legal moves, which must still be checked with Position::is_legal.
+        template <GenType kType>
+        void generate(const Position &pos, MoveList &moves);
+
+        void generate_legal(const Position &pos, MoveList &moves);
+    }
+}
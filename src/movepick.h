@@ -0,0 +1,164 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "core.h"
+#include "move.h"
+#include "movegen.h"
+#include "position.h"
+#include "stats.h"
+#include "types.h"
+#include "utils/mdarray.h"
+
+namespace purebred {
+
+    // Butterfly history, indexed by [side to move][from][to]
+    using ButterflyHistory = utils::MDArray<i16, Colour::kNumTypes, Square::kNumTypes, Square::kNumTypes>;
+
+    // Hands out pseudo-legal moves in stages, roughly best-first: the TT move, then noisy moves by MVV-LVA,
+    // then the killer, then the remaining quiets by history. The TT move and killer are validated directly,
+    // so a cutoff on either of them happens before any move generation.
+    class MovePicker {
+    public:
+        MovePicker(const Position &pos, Move ttMove, Move killer, const ButterflyHistory &history, bool noisyOnly)
+            : mPos(pos), mHistory(history), mNoisyOnly(noisyOnly) {
+
+            if (pos.is_pseudo_legal(ttMove) && (!noisyOnly || pos.is_noisy(ttMove))) mTTMove = ttMove;
+            if (!noisyOnly && killer != mTTMove && pos.is_pseudo_legal(killer) && !pos.is_noisy(killer)) mKiller = killer;
+
+            mStage = mTTMove != Moves::kNone ? Stage::kTTMove : Stage::kGenNoisy;
+        }
+
+        // Returns Moves::kNone once all moves have been handed out.
+        [[nodiscard]] Move next() {
+            switch (mStage) {
+                case Stage::kTTMove:
+                    mStage = Stage::kGenNoisy;
+                    mSource = stats::Source::kTTMove;
+                    return mTTMove;
+
+                case Stage::kGenNoisy:
+                    movegen::generate<movegen::GenType::kNoisy>(mPos, mMoves);
+                    this->score_moves<true>();
+                    mStage = Stage::kNoisy;
+                    [[fallthrough]];
+
+                case Stage::kNoisy:
+                    for (Move move = this->select(); move != Moves::kNone; move = this->select()) {
+                        if (move == mTTMove) continue;
+                        mSource = stats::Source::kNoisy;
+                        return move;
+                    }
+
+                    mStage = mNoisyOnly ? Stage::kDone : Stage::kKiller;
+                    if (mNoisyOnly) return Moves::kNone;
+                    [[fallthrough]];
+
+                case Stage::kKiller:
+                    mStage = Stage::kGenQuiet;
+                    if (mKiller != Moves::kNone) {
+                        mSource = stats::Source::kKiller;
+                        return mKiller;
+                    }
+                    [[fallthrough]];
+
+                case Stage::kGenQuiet:
+                    mMoves.clear();
+                    mIdx = 0;
+                    movegen::generate<movegen::GenType::kQuiet>(mPos, mMoves);
+                    this->score_moves<false>();
+                    mStage = Stage::kQuiet;
+                    [[fallthrough]];
+
+                case Stage::kQuiet:
+                    for (Move move = this->select(); move != Moves::kNone; move = this->select()) {
+                        if (move == mTTMove || move == mKiller) continue;
+                        mSource = stats::Source::kQuiet;
+                        return move;
+                    }
+
+                    mStage = Stage::kDone;
+                    [[fallthrough]];
+
+                default:
+                    return Moves::kNone;
+            }
+        }
+
+        // Which stage the most recently returned move came from, for search statistics
+        [[nodiscard]] stats::Source source() const {
+            return mSource;
+        }
+
+    private:
+        enum class Stage {
+            kTTMove,
+            kGenNoisy,
+            kNoisy,
+            kKiller,
+            kGenQuiet,
+            kQuiet,
+            kDone
+        };
+
+        const Position &mPos;
+        const ButterflyHistory &mHistory;
+        bool mNoisyOnly;
+
+        Move mTTMove = Moves::kNone;
+        Move mKiller = Moves::kNone;
+        Stage mStage;
+        stats::Source mSource = stats::Source::kQuiet;
+
+        MoveList mMoves;
+        utils::MDArray<i32, kMaxMoves> mScores;
+        usize mIdx = 0;
+
+        template <bool kNoisy>
+        void score_moves() {
+            for (usize i = mIdx; i < mMoves.size(); ++i) {
+                const Move move = mMoves[i];
+
+                if constexpr (kNoisy) {
+                    const PieceType victim = move.type() == Move::Type::kEnPassant ? PieceTypes::kPawn : mPos.piece_on(move.to()).type();
+                    const PieceType attacker = mPos.piece_on(move.from()).type();
+                    const i32 promo = move.type() == Move::Type::kPromotion ? PieceTypes::kQueen.raw() : 0;
+                    mScores[i] = (victim ? victim.raw() * 8 : 0) + promo * 8 - attacker.raw();
+                } else {
+                    mScores[i] = mHistory[mPos.stm()][move.from()][move.to()];
+                }
+            }
+        }
+
+        // Selection sort: in most nodes only the first few moves of a stage are ever looked at
+        [[nodiscard]] Move select() {
+            if (mIdx == mMoves.size()) return Moves::kNone;
+
+            usize best = mIdx;
+            for (usize i = mIdx + 1; i < mMoves.size(); ++i) {
+                if (mScores[i] > mScores[best]) best = i;
+            }
+
+            std::swap(mMoves[mIdx], mMoves[best]);
+            std::swap(mScores[mIdx], mScores[best]);
+            return mMoves[mIdx++];
+        }
+    };
+}
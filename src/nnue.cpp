@@ -0,0 +1,317 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "nnue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+
+#if defined(USE_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace purebred::nnue {
+
+    namespace {
+        std::unique_ptr<Network> gNetwork;
+
+        // Size of a network file with the given number of output buckets, including the padding
+        [[nodiscard]] constexpr usize file_size(usize buckets) {
+            const usize size = (kInputs * kHidden + kHidden + buckets * (2 * kHidden + 1)) * sizeof(i16);
+            return (size + 63) / 64 * 64;
+        }
+
+        // The activation kernels multiply a clipped activation by an output weight in 16 bits, which is exact
+        // as long as the weight's magnitude is at most 128. This also keeps each half of the output in 32 bits.
+        constexpr i32 kMaxOutputWeight = 128;
+        static_assert(static_cast<i64>(kQA) * kQA * kMaxOutputWeight * kHidden <= std::numeric_limits<i32>::max());
+
+        struct Feature {
+            Piece piece;
+            Square sq;
+
+            [[nodiscard]] constexpr bool operator==(const Feature &) const = default;
+        };
+
+        // The features added and removed by a single move, in either perspective
+        struct Delta {
+            utils::MDArray<Feature, 2> adds;
+            utils::MDArray<Feature, 2> subs;
+            usize numAdds = 0;
+            usize numSubs = 0;
+
+            void add(Piece pc, Square sq) {
+                adds[numAdds++] = {pc, sq};
+            }
+
+            void sub(Piece pc, Square sq) {
+                subs[numSubs++] = {pc, sq};
+            }
+        };
+
+        [[nodiscard]] usize feature_index(Colour perspective, Piece pc, Square sq) {
+            const usize side = pc.colour() == perspective ? 0 : 1;
+            return side * 384 + pc.type().raw() * 64 + sq.orient(perspective).raw();
+        }
+
+        // Recovers what a move changed on the board from the states before and after it
+        [[nodiscard]] Delta move_delta(const BoardState &before, const BoardState &after) {
+            Delta delta;
+            const Move move = after.move;
+            if (move == Moves::kNone) return delta;
+
+            const Square from = move.from(), to = move.to();
+            const Piece moved = before.mailbox[from];
+
+            switch (move.type()) {
+                case Move::Type::kCastling:
+                    delta.sub(moved, from);
+                    delta.sub(before.mailbox[to], to);
+                    delta.add(moved, move.castle_king_to());
+                    delta.add(before.mailbox[to], move.castle_rook_to());
+                    break;
+
+                case Move::Type::kEnPassant:
+                    delta.sub(moved, from);
+                    delta.add(moved, to);
+                    delta.sub(after.captured, Square{from.rank(), to.file()});
+                    break;
+
+                case Move::Type::kNormal:
+                case Move::Type::kPromotion:
+                    delta.sub(moved, from);
+                    delta.add(after.mailbox[to], to);
+                    if (after.captured) delta.sub(after.captured, to);
+                    break;
+            }
+
+            return delta;
+        }
+
+        void apply_delta(const Accumulator &src, Accumulator &dst, const Delta &delta) {
+            for (Colour perspective : {Colours::kWhite, Colours::kBlack}) {
+                const i16 *in = src.values[perspective].data();
+                i16 *out = dst.values[perspective].data();
+                std::copy(in, in + kHidden, out);
+
+                for (usize i = 0; i < delta.numAdds; ++i) {
+                    const i16 *weights = gNetwork->featureWeights[feature_index(perspective, delta.adds[i].piece, delta.adds[i].sq)].data();
+                    for (usize j = 0; j < kHidden; ++j) out[j] = static_cast<i16>(out[j] + weights[j]);
+                }
+
+                for (usize i = 0; i < delta.numSubs; ++i) {
+                    const i16 *weights = gNetwork->featureWeights[feature_index(perspective, delta.subs[i].piece, delta.subs[i].sq)].data();
+                    for (usize j = 0; j < kHidden; ++j) out[j] = static_cast<i16>(out[j] - weights[j]);
+                }
+            }
+        }
+
+#if defined(USE_AVX2)
+        [[nodiscard]] i32 horizontal_sum(__m256i v) {
+            const __m128i half = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            const __m128i quarter = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0b01'00'11'10));
+            return _mm_cvtsi128_si32(_mm_add_epi32(quarter, _mm_shuffle_epi32(quarter, 0b10'11'00'01)));
+        }
+#endif
+
+        // Sum over the hidden layer of clamp(x, 0, QA)^2 * w, in units of QA * QA * QB. With USE_SPARSE, a first
+        // pass builds a mask of the register-sized chunks holding a positive input and only those are multiplied,
+        // which pays off when most activations are zero.
+        [[nodiscard]] i32 screlu_dot(const i16 *inputs, const i16 *weights) {
+#if defined(USE_AVX512)
+            constexpr usize kChunk = 32;
+            const __m512i zero = _mm512_setzero_si512();
+            const __m512i one = _mm512_set1_epi16(kQA);
+            __m512i sum = _mm512_setzero_si512();
+
+            const auto accumulate = [&](usize i) {
+                const __m512i x = _mm512_min_epi16(_mm512_max_epi16(_mm512_load_si512(inputs + i), zero), one);
+                const __m512i w = _mm512_load_si512(weights + i);
+                sum = _mm512_add_epi32(sum, _mm512_madd_epi16(_mm512_mullo_epi16(x, w), x));
+            };
+
+#if defined(USE_SPARSE)
+            static_assert(kHidden / kChunk <= 64);
+            u64 nonzero = 0;
+            for (usize i = 0; i < kHidden / kChunk; ++i) {
+                const __mmask32 positive = _mm512_cmpgt_epi16_mask(_mm512_load_si512(inputs + i * kChunk), zero);
+                nonzero |= static_cast<u64>(positive != 0) << i;
+            }
+            for (; nonzero; nonzero &= nonzero - 1) accumulate(static_cast<usize>(__builtin_ctzll(nonzero)) * kChunk);
+#else
+            for (usize i = 0; i < kHidden; i += kChunk) accumulate(i);
+#endif
+
+            // Masked extracts sidestep a spurious -Wuninitialized from the unmasked ones in GCC 12
+            return horizontal_sum(_mm256_add_epi32(_mm512_maskz_extracti64x4_epi64(0xF, sum, 0), _mm512_maskz_extracti64x4_epi64(0xF, sum, 1)));
+#elif defined(USE_AVX2)
+            constexpr usize kChunk = 16;
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i one = _mm256_set1_epi16(kQA);
+            __m256i sum = _mm256_setzero_si256();
+
+            const auto accumulate = [&](usize i) {
+                const __m256i x = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i *>(inputs + i)), zero), one);
+                const __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i *>(weights + i));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_mullo_epi16(x, w), x));
+            };
+
+#if defined(USE_SPARSE)
+            static_assert(kHidden / kChunk <= 64);
+            u64 nonzero = 0;
+            for (usize i = 0; i < kHidden / kChunk; ++i) {
+                const __m256i positive = _mm256_cmpgt_epi16(_mm256_load_si256(reinterpret_cast<const __m256i *>(inputs + i * kChunk)), zero);
+                nonzero |= static_cast<u64>(!_mm256_testz_si256(positive, positive)) << i;
+            }
+            for (; nonzero; nonzero &= nonzero - 1) accumulate(static_cast<usize>(__builtin_ctzll(nonzero)) * kChunk);
+#else
+            for (usize i = 0; i < kHidden; i += kChunk) accumulate(i);
+#endif
+
+            return horizontal_sum(sum);
+#else
+            i32 sum = 0;
+            for (usize i = 0; i < kHidden; ++i) {
+                const i32 x = std::clamp<i32>(inputs[i], 0, kQA);
+                sum += x * x * weights[i];
+            }
+            return sum;
+#endif
+        }
+    }
+
+    bool load(const std::string &path) {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+
+        // The number of output buckets is recognised from the size of the file
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        std::rewind(file);
+
+        usize buckets = 0;
+        if (size >= 0 && static_cast<usize>(size) == file_size(kOutputBuckets)) buckets = kOutputBuckets;
+        else if (size >= 0 && static_cast<usize>(size) == file_size(1)) buckets = 1;
+
+        auto network = std::make_unique<Network>();
+        bool ok = buckets != 0
+               && std::fread(network->featureWeights.data(), sizeof(i16), kInputs * kHidden, file) == kInputs * kHidden
+               && std::fread(network->featureBias.data(), sizeof(i16), kHidden, file) == kHidden;
+        for (usize bucket = 0; bucket < buckets; ++bucket)
+            ok = ok && std::fread(network->outputWeights[bucket].data(), sizeof(i16), 2 * kHidden, file) == 2 * kHidden;
+        ok = ok && std::fread(network->outputBias.data(), sizeof(i16), buckets, file) == buckets;
+        std::fclose(file);
+
+        for (const auto &row : network->outputWeights) {
+            ok = ok && std::all_of(row.begin(), row.end(), [](i16 w) { return std::abs(w) <= kMaxOutputWeight; });
+        }
+        if (!ok) return false;
+
+        // A single-bucket network uses the same head everywhere
+        for (usize bucket = buckets; bucket < kOutputBuckets; ++bucket) {
+            network->outputWeights[bucket] = network->outputWeights[0];
+            network->outputBias[bucket] = network->outputBias[0];
+        }
+
+        gNetwork = std::move(network);
+        return true;
+    }
+
+    void unload() {
+        gNetwork.reset();
+    }
+
+    bool loaded() {
+        return gNetwork != nullptr;
+    }
+
+    void refresh(Accumulator &acc, const Position &pos) {
+        for (Colour perspective : {Colours::kWhite, Colours::kBlack}) {
+            i16 *out = acc.values[perspective].data();
+            std::copy(gNetwork->featureBias.begin(), gNetwork->featureBias.end(), out);
+
+            for (Square sq : pos.pieces()) {
+                const i16 *weights = gNetwork->featureWeights[feature_index(perspective, pos.piece_on(sq), sq)].data();
+                for (usize j = 0; j < kHidden; ++j) out[j] = static_cast<i16>(out[j] + weights[j]);
+            }
+        }
+    }
+
+    usize output_bucket(const Position &pos) {
+        constexpr usize kDivisor = (32 + kOutputBuckets - 1) / kOutputBuckets;
+        return std::min(static_cast<usize>(pos.pieces().count_bits() - 2) / kDivisor, kOutputBuckets - 1);
+    }
+
+    Score forward(const Accumulator &acc, Colour stm, usize bucket) {
+        const i16 *weights = gNetwork->outputWeights[bucket].data();
+
+        // Each half is bounded by QA * QA * 128 * kHidden and fits in 32 bits, but their sum does not
+        const i64 sum = static_cast<i64>(screlu_dot(acc.values[stm].data(), weights))
+                      + screlu_dot(acc.values[stm.flip()].data(), weights + kHidden);
+
+        const i32 output = static_cast<i32>((sum / kQA + gNetwork->outputBias[bucket]) * kScale / (kQA * kQB));
+        return std::clamp(output, -Scores::kMateInMaxPly + 1, Scores::kMateInMaxPly - 1);
+    }
+
+    Score evaluate(const Position &pos) {
+        Accumulator acc;
+        refresh(acc, pos);
+        return forward(acc, pos.stm(), output_bucket(pos));
+    }
+
+    void AccumulatorStack::reset(const Position &pos) {
+        mRootPly = pos.game_ply();
+        for (Entry &entry : mEntries) entry.computed = false;
+    }
+
+    Score AccumulatorStack::evaluate(const Position &pos, stats::Counters &stats) {
+        // Replaying more moves than this costs about as much as a refresh
+        constexpr usize kMaxReplay = 8;
+
+        const usize current = pos.game_ply() - mRootPly;
+        assert(pos.game_ply() >= mRootPly && current <= kMaxPly);
+
+        usize base = current;
+        while (!(mEntries[base].computed && mEntries[base].key == pos.state_at(mRootPly + base).key)) {
+            if (base == 0 || current - base >= kMaxReplay) {
+                refresh(mEntries[current].acc, pos);
+                mEntries[current].key = pos.key();
+                mEntries[current].computed = true;
+                stats.inc(stats::Counter::kNnueRefreshes);
+                return forward(mEntries[current].acc, pos.stm(), output_bucket(pos));
+            }
+            base--;
+        }
+
+        for (usize ply = base + 1; ply <= current; ++ply) {
+            const BoardState &before = pos.state_at(mRootPly + ply - 1), &after = pos.state_at(mRootPly + ply);
+            apply_delta(mEntries[ply - 1].acc, mEntries[ply].acc, move_delta(before, after));
+            mEntries[ply].key = after.key;
+            mEntries[ply].computed = true;
+            stats.inc(stats::Counter::kNnueUpdates);
+        }
+
+        assert(forward(mEntries[current].acc, pos.stm(), output_bucket(pos)) == nnue::evaluate(pos));
+        return forward(mEntries[current].acc, pos.stm(), output_bucket(pos));
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "core.h"
+#include "position.h"
+#include "stats.h"
+#include "types.h"
+#include "utils/mdarray.h"
+
+#include <string>
+
+// A (768 -> 256)x2 -> 1x8 network with a squared clipped ReLU activation, in the plain little-endian i16 layout
+// written by common trainers: feature weights, feature biases, output weights (one row per output bucket, side
+// to move's half first), output biases, padded to a multiple of 64 bytes. Networks with a single output bucket
+// are also accepted. When no network is loaded the handcrafted eval is used.
+namespace purebred::nnue {
+
+    constexpr usize kInputs = 768;
+    constexpr usize kHidden = 256;
+
+    // The output head is chosen by the number of pieces on the board
+    constexpr usize kOutputBuckets = 8;
+
+    // Quantisation of the feature transformer and output layer, and the scale from network output to centipawns
+    constexpr i32 kQA = 255;
+    constexpr i32 kQB = 64;
+    constexpr i32 kScale = 400;
+
+    struct alignas(64) Network {
+        utils::MDArray<i16, kInputs, kHidden> featureWeights;
+        utils::MDArray<i16, kHidden> featureBias;
+        utils::MDArray<i16, kOutputBuckets, 2 * kHidden> outputWeights;
+        utils::MDArray<i16, kOutputBuckets> outputBias;
+    };
+
+    struct alignas(64) Accumulator {
+        utils::MDArray<i16, Colour::kNumTypes, kHidden> values;
+
+        [[nodiscard]] bool operator==(const Accumulator &) const = default;
+    };
+
+    // Loads a network, replacing any previous one. On failure the previous network (or lack of one) is kept.
+    // Must not be called while anything is evaluating.
+    [[nodiscard]] bool load(const std::string &path);
+    void unload();
+    [[nodiscard]] bool loaded();
+
+    void refresh(Accumulator &acc, const Position &pos);
+    [[nodiscard]] usize output_bucket(const Position &pos);
+    [[nodiscard]] Score forward(const Accumulator &acc, Colour stm, usize bucket);
+
+    // Evaluates from scratch, from the point of view of the side to move. Requires a loaded network.
+    [[nodiscard]] Score evaluate(const Position &pos);
+
+    // The accumulators of every position along the current line, indexed by ply from the root. They are brought
+    // up to date lazily when a position is evaluated, by applying the moves made since the nearest computed ancestor.
+    class AccumulatorStack {
+    public:
+        // Invalidates every accumulator and makes pos the root; called whenever a new search starts
+        void reset(const Position &pos);
+
+        [[nodiscard]] Score evaluate(const Position &pos, stats::Counters &stats);
+
+    private:
+        struct Entry {
+            Accumulator acc;
+            u64 key = 0;
+            bool computed = false;
+
+            [[nodiscard]] bool operator==(const Entry &) const = default;
+        };
+
+        utils::MDArray<Entry, kMaxPly + 1> mEntries;
+        usize mRootPly = 0;
+    };
+}
@@ -0,0 +1,118 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "bitboard.h"
+#include "core.h"
+#include "position.h"
+#include "types.h"
+#include "utils/mdarray.h"
+
+#include <string>
+
+namespace purebred {
+
+    // Game outcome from White's point of view
+    struct WDL {
+        constexpr WDL() = delete;
+
+        static constexpr u8 kBlackWin = 0;
+        static constexpr u8 kDraw = 1;
+        static constexpr u8 kWhiteWin = 2;
+    };
+
+    // A 32-byte training record (laid out like marlinformat):
+    // the occupancy, then one nibble per occupied square in LSB-first order holding the piece index, with the
+    // two extra values 12 and 13 marking a White/Black rook which still has castling rights.
+    // Scores and results are stored from White's point of view.
+    struct PackedBoard {
+        static constexpr u8 kWhiteCastlingRook = Piece::kNumTypes;
+        static constexpr u8 kBlackCastlingRook = Piece::kNumTypes + 1;
+
+        static constexpr u8 kBlackToMove = 0x80;
+        static constexpr u8 kNoEpSquare = Square::kNumTypes;
+
+        u64 occupancy;
+        utils::MDArray<u8, 16> pieces;
+        u8 stmEpSquare;
+        u8 halfmove;
+        u16 fullmove;
+        i16 score;
+        u8 wdl;
+        u8 extra;
+
+        [[nodiscard]] static PackedBoard pack(const Position &pos, Score whiteScore, u8 wdl) {
+            PackedBoard packed{};
+            packed.occupancy = pos.pieces();
+
+            usize i = 0;
+            for (Square sq : pos.pieces()) {
+                u8 nibble = pos.piece_on(sq).raw();
+                for (usize c = 0; c < Colour::kNumTypes; ++c) {
+                    for (usize side = 0; side < CastlingSides::kNum; ++side) {
+                        if (pos.castling_rook(Colour{c}, side) == sq)
+                            nibble = Colour{c} == Colours::kWhite ? kWhiteCastlingRook : kBlackCastlingRook;
+                    }
+                }
+
+                packed.pieces[i / 2] |= static_cast<u8>(nibble << (4 * (i % 2)));
+                i++;
+            }
+
+            packed.stmEpSquare = static_cast<u8>((pos.stm() == Colours::kBlack ? kBlackToMove : 0)
+                                                 | (pos.ep_square() ? pos.ep_square().raw() : kNoEpSquare));
+            packed.halfmove = static_cast<u8>(std::min<u16>(pos.halfmove(), 255));
+            packed.fullmove = pos.fullmove();
+            packed.score = static_cast<i16>(whiteScore);
+            packed.wdl = wdl;
+            packed.extra = 0;
+
+            return packed;
+        }
+
+        [[nodiscard]] u8 nibble(usize i) const {
+            return (pieces[i / 2] >> (4 * (i % 2))) & 0xF;
+        }
+
+        [[nodiscard]] Piece piece(usize i) const {
+            const u8 n = this->nibble(i);
+            if (n == kWhiteCastlingRook) return Pieces::kWhiteRook;
+            if (n == kBlackCastlingRook) return Pieces::kBlackRook;
+            return Piece{n};
+        }
+
+        [[nodiscard]] Colour stm() const {
+            return stmEpSquare & kBlackToMove ? Colours::kBlack : Colours::kWhite;
+        }
+
+        [[nodiscard]] Square ep_square() const {
+            const u8 sq = stmEpSquare & ~kBlackToMove;
+            return sq == kNoEpSquare ? Squares::kNone : Square{sq};
+        }
+
+        // Returns an empty string if the record does not describe a valid position.
+        [[nodiscard]] std::string to_fen() const {
+            const auto pos = Position::from_packed(*this);
+            return pos ? pos->to_fen() : std::string{};
+        }
+    };
+
+    static_assert(sizeof(PackedBoard) == 32);
+}
@@ -0,0 +1,52 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "tune.h"
+#include "types.h"
+
+// Search parameters. Fractional values are scaled by 100.
+namespace purebred::params {
+
+    TUNABLE(aspDelta, 25, 10, 60, 5)
+
+    TUNABLE(rfpDepth, 7, 4, 10, 1)
+    TUNABLE(rfpMargin, 80, 40, 150, 8)
+
+    TUNABLE(nmpMinDepth, 3, 2, 5, 1)
+    TUNABLE(nmpBase, 3, 2, 5, 1)
+    TUNABLE(nmpDivisor, 3, 2, 6, 1)
+
+    TUNABLE(lmpBase, 3, 1, 6, 1)
+
+    TUNABLE(fpDepth, 6, 3, 9, 1)
+    TUNABLE(fpBase, 100, 40, 200, 10)
+    TUNABLE(fpScale, 100, 40, 200, 10)
+
+    TUNABLE(seMinDepth, 8, 5, 10, 1)
+    TUNABLE(seMargin, 2, 1, 5, 1)
+
+    TUNABLE(lmrBase, 75, 25, 150, 8)
+    TUNABLE(lmrDivisor, 225, 150, 350, 12)
+
+    TUNABLE(histBonusQuad, 16, 4, 32, 2)
+    TUNABLE(histBonusLinear, 32, 0, 96, 8)
+    TUNABLE(histBonusMax, 1600, 800, 3200, 100)
+}
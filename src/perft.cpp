@@ -0,0 +1,108 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "perft.h"
+
+#include "movegen.h"
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string_view>
+
+namespace purebred {
+
+    namespace {
+        struct PerftCase {
+            std::string_view fen;
+            i32 depth;
+            u64 nodes;
+        };
+
+        constexpr std::array<PerftCase, 9> kPerftSuite = {{
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609},
+            {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+            {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+            {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+            {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+            {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+
+            // Chess960, with Shredder-FEN castling rights
+            {"bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9", 4, 326672},
+            {"2nnrbkr/p1qppppp/8/1ppb4/6PP/3PP3/PPP2P2/BQNNRBKR w HEhe - 1 9", 4, 667366},
+            {"b1q1rrkb/pppppppp/3nn3/8/P7/1PPP4/4PPPP/BQNNRKRB w GE - 1 9", 4, 273318},
+        }};
+    }
+
+    u64 perft(Position &pos, i32 depth) {
+        MoveList moves;
+        movegen::generate_legal(pos, moves);
+
+        // Bulk counting: at the last ply, the number of legal moves is the number of leaf nodes
+        if (depth <= 1) return depth == 1 ? moves.size() : 1;
+
+        u64 nodes = 0;
+        for (Move move : moves) {
+            pos.make_move(move);
+            nodes += perft(pos, depth - 1);
+            pos.unmake_move();
+        }
+
+        return nodes;
+    }
+
+    void split_perft(Position &pos, i32 depth, bool chess960) {
+        const auto start = std::chrono::steady_clock::now();
+
+        MoveList moves;
+        movegen::generate_legal(pos, moves);
+
+        u64 total = 0;
+        for (Move move : moves) {
+            pos.make_move(move);
+            const u64 nodes = depth > 1 ? perft(pos, depth - 1) : 1;
+            pos.unmake_move();
+
+            total += nodes;
+            std::cout << move.to_str(chess960) << ": " << nodes << "\n";
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "\nNodes searched: " << total << "\n";
+        std::cout << "Time: " << elapsed << " ms\n";
+        std::cout << "NPS: " << total * 1000 / static_cast<u64>(std::max<i64>(elapsed, 1)) << std::endl;
+    }
+
+    i32 run_perft_suite() {
+        usize failures = 0;
+
+        for (const PerftCase &test : kPerftSuite) {
+            auto pos = Position::from_fen(test.fen);
+            const u64 nodes = pos ? perft(*pos, test.depth) : 0;
+            const bool passed = nodes == test.nodes;
+            failures += !passed;
+
+            std::cout << (passed ? "PASS " : "FAIL ") << test.fen << " ; depth " << test.depth
+                      << " ; expected " << test.nodes << " ; got " << nodes << std::endl;
+        }
+
+        std::cout << kPerftSuite.size() - failures << "/" << kPerftSuite.size() << " passed" << std::endl;
+        return failures ? 1 : 0;
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "position.h"
+#include "types.h"
+
+namespace purebred {
+
+    [[nodiscard]] u64 perft(Position &pos, i32 depth);
+
+    // Prints the node count below each root move, followed by the total and the speed.
+    void split_perft(Position &pos, i32 depth, bool chess960 = false);
+
+    // Checks move generation against known node counts for standard chess and Chess960 positions,
+    // as `Purebred perft`. Returns the process exit code.
+    [[nodiscard]] i32 run_perft_suite();
+}
@@ -0,0 +1,682 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "position.h"
+
+#include "cuckoo.h"
+#include "movegen.h"
+#include "packed.h"
+#include "utils/parse.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace purebred {
+
+    Position Position::startpos() {
+        return *Position::from_fen(kStartPosFen);
+    }
+
+    Position Position::empty() {
+        Position pos;
+        pos.reset();
+        return pos;
+    }
+
+    void Position::reset() {
+        mStates.clear();
+        mStates.emplace_back();
+
+        BoardState &st = this->state_mut();
+        st.pieceBBs.fill(Bitboards::kEmpty);
+        st.colourBBs.fill(Bitboards::kEmpty);
+        st.mailbox.fill(Pieces::kNone);
+        st.castlingRooks.fill(Squares::kNone);
+        st.key = 0;
+        st.checkers = Bitboards::kEmpty;
+        st.pinned = Bitboards::kEmpty;
+        st.epSquare = Squares::kNone;
+        st.stm = Colours::kWhite;
+        st.halfmove = 0;
+        st.fullmove = 1;
+        st.pliesFromNull = 0;
+        st.move = Moves::kNone;
+        st.captured = Pieces::kNone;
+    }
+
+    std::optional<Position> Position::from_packed(const PackedBoard &packed) {
+        Position pos;
+        if (!pos.set_packed(packed)) return std::nullopt;
+        return pos;
+    }
+
+    bool Position::set_packed(const PackedBoard &packed) {
+        this->reset();
+        BoardState &st = this->state_mut();
+
+        // Records come from files, so everything is validated before it is used: there are only nibbles for 32
+        // pieces, and the values above the castling rooks do not describe anything
+        const Bitboard occupancy{packed.occupancy};
+        const usize pieceCount = static_cast<usize>(occupancy.count_bits());
+        if (pieceCount > 32) return false;
+        for (usize i = 0; i < pieceCount; ++i) {
+            if (packed.nibble(i) > PackedBoard::kBlackCastlingRook) return false;
+        }
+
+        const u8 epByte = packed.stmEpSquare & ~PackedBoard::kBlackToMove;
+        if (epByte > PackedBoard::kNoEpSquare) return false;
+
+        usize i = 0;
+        for (Square sq : occupancy) this->put_piece(packed.piece(i++), sq);
+
+        if (this->pieces(Colours::kWhite, PieceTypes::kKing).count_bits() != 1) return false;
+        if (this->pieces(Colours::kBlack, PieceTypes::kKing).count_bits() != 1) return false;
+        if (this->pieces(PieceTypes::kPawn) & (Bitboards::kRank1 | Bitboards::kRank8)) return false;
+
+        i = 0;
+        for (Square sq : occupancy) {
+            const u8 nibble = packed.nibble(i++);
+            if (nibble != PackedBoard::kWhiteCastlingRook && nibble != PackedBoard::kBlackCastlingRook) continue;
+
+            // As in from_fen, castling rooks stand on their back rank along with their king, one on each side
+            const Colour colour = nibble == PackedBoard::kWhiteCastlingRook ? Colours::kWhite : Colours::kBlack;
+            const i32 backRank = colour == Colours::kWhite ? Ranks::k1 : Ranks::k8;
+            const Square ksq = this->king_sq(colour);
+            if (sq.rank() != backRank || ksq.rank() != backRank) return false;
+
+            const usize side = sq.file() > ksq.file() ? CastlingSides::kKingside : CastlingSides::kQueenside;
+            if (st.castlingRooks[colour][side]) return false;
+            st.castlingRooks[colour][side] = sq;
+        }
+        st.key ^= zobrist::castling(this->castling_mask());
+
+        st.stm = packed.stm();
+        if (st.stm == Colours::kBlack) st.key ^= zobrist::stm();
+
+        st.halfmove = packed.halfmove;
+        st.fullmove = packed.fullmove;
+
+        // The side not to move must not be in check
+        if (this->is_attacked(this->king_sq(st.stm.flip()), st.stm, this->pieces())) return false;
+
+        if (const Square epSq = packed.ep_square()) {
+            if (epSq.rank() != (st.stm == Colours::kWhite ? Ranks::k6 : Ranks::k3)) return false;
+            this->set_ep_square(epSq);
+        }
+
+        this->update_check_info();
+        return true;
+    }
+
+    std::optional<Position> Position::from_fen(std::string_view fen) {
+        const std::string_view board = utils::next_token(fen), stm = utils::next_token(fen);
+        const std::string_view castling = utils::next_token(fen), ep = utils::next_token(fen);
+        if (ep.empty()) return std::nullopt;
+
+        // The move counters are optional, as EPD strings do not include them
+        u32 halfmove = 0, fullmove = 1;
+        if (const auto parsed = utils::parse_int<u32>(utils::next_token(fen))) {
+            halfmove = *parsed;
+            fullmove = utils::parse_int<u32>(utils::next_token(fen)).value_or(1);
+        }
+
+        Position pos = Position::empty();
+        BoardState &st = pos.state_mut();
+
+        i32 rank = Ranks::k8, file = Files::kA;
+        for (char c : board) {
+            if (c == '/') {
+                if (file != Files::kNum || rank == Ranks::k1) return std::nullopt;
+                rank--;
+                file = Files::kA;
+            } else if (c >= '1' && c <= '8') {
+                file += c - '0';
+                if (file > Files::kNum) return std::nullopt;
+            } else {
+                const Piece pc = Piece::from_char(c);
+                if (!pc || file >= Files::kNum) return std::nullopt;
+                pos.put_piece(pc, Square{rank, file});
+                file++;
+            }
+        }
+
+        if (rank != Ranks::k1 || file != Files::kNum) return std::nullopt;
+        if (pos.pieces(Colours::kWhite, PieceTypes::kKing).count_bits() != 1) return std::nullopt;
+        if (pos.pieces(Colours::kBlack, PieceTypes::kKing).count_bits() != 1) return std::nullopt;
+        if (pos.pieces(PieceTypes::kPawn) & (Bitboards::kRank1 | Bitboards::kRank8)) return std::nullopt;
+
+        if (stm.size() != 1) return std::nullopt;
+        st.stm = Colour::from_char(stm[0]);
+        if (!st.stm) return std::nullopt;
+        if (st.stm == Colours::kBlack) st.key ^= zobrist::stm();
+
+        // Castling rights may be given as KQkq (X-FEN: the outermost rook on that side of the king),
+        // or as the file of the castling rook (Shredder-FEN), which Chess960 needs when the outermost rook is not it
+        if (castling != "-") {
+            for (char c : castling) {
+                const Colour colour = std::isupper(c) ? Colours::kWhite : Colours::kBlack;
+                const i32 backRank = colour == Colours::kWhite ? Ranks::k1 : Ranks::k8;
+                const Square ksq = pos.king_sq(colour);
+                const Piece rook{colour, PieceTypes::kRook};
+                const char lower = static_cast<char>(std::tolower(c));
+
+                if (ksq.rank() != backRank) return std::nullopt;
+
+                Square rookSq = Squares::kNone;
+                if (lower == 'k') {
+                    for (i32 f = Files::kH; f > ksq.file() && !rookSq; --f) {
+                        if (pos.piece_on(Square{backRank, f}) == rook) rookSq = Square{backRank, f};
+                    }
+                } else if (lower == 'q') {
+                    for (i32 f = Files::kA; f < ksq.file() && !rookSq; ++f) {
+                        if (pos.piece_on(Square{backRank, f}) == rook) rookSq = Square{backRank, f};
+                    }
+                } else if (lower >= 'a' && lower <= 'h') {
+                    rookSq = Square{backRank, lower - 'a'};
+                }
+
+                if (!rookSq || pos.piece_on(rookSq) != rook) return std::nullopt;
+
+                const usize side = rookSq.file() > ksq.file() ? CastlingSides::kKingside : CastlingSides::kQueenside;
+                st.castlingRooks[colour][side] = rookSq;
+            }
+        }
+        st.key ^= zobrist::castling(pos.castling_mask());
+
+        st.halfmove = static_cast<u16>(halfmove);
+        st.fullmove = static_cast<u16>(std::max(fullmove, U32C(1)));
+
+        // The side not to move must not be in check
+        if (pos.is_attacked(pos.king_sq(st.stm.flip()), st.stm, pos.pieces())) return std::nullopt;
+
+        if (ep != "-") {
+            const Square epSq = Square::from_str(ep);
+            if (!epSq || epSq.rank() != (st.stm == Colours::kWhite ? Ranks::k6 : Ranks::k3)) return std::nullopt;
+            pos.set_ep_square(epSq);
+        }
+
+        pos.update_check_info();
+        return pos;
+    }
+
+    std::string Position::to_fen() const {
+        const BoardState &st = this->state();
+        std::string fen;
+
+        for (i32 rank = Ranks::k8; rank >= Ranks::k1; --rank) {
+            i32 empty = 0;
+            for (i32 file = Files::kA; file <= Files::kH; ++file) {
+                const Piece pc = this->piece_on(Square{rank, file});
+                if (!pc) {
+                    empty++;
+                    continue;
+                }
+
+                if (empty) fen += static_cast<char>('0' + empty);
+                empty = 0;
+                fen += pc.to_char();
+            }
+
+            if (empty) fen += static_cast<char>('0' + empty);
+            if (rank != Ranks::k1) fen += '/';
+        }
+
+        fen += ' ';
+        fen += st.stm.to_char();
+        fen += ' ';
+
+        // X-FEN: KQkq where that identifies the rook, and the rook's file when another rook is further out
+        const usize before = fen.size();
+        for (Colour c : {Colours::kWhite, Colours::kBlack}) {
+            for (usize side : {CastlingSides::kKingside, CastlingSides::kQueenside}) {
+                const Square rookSq = st.castlingRooks[c][side];
+                if (!rookSq) continue;
+
+                const Bitboard backRank = Bitboards::kRanks[rookSq.rank()];
+                const Bitboard outside = side == CastlingSides::kKingside ? Bitboard{~((U64C(2) << rookSq.raw()) - 1)}
+                                                                          : Bitboard{(U64C(1) << rookSq.raw()) - 1};
+                const bool outermost = !(this->pieces(c, PieceTypes::kRook) & backRank & outside);
+
+                const char letter = outermost ? (side == CastlingSides::kKingside ? 'k' : 'q') : static_cast<char>('a' + rookSq.file());
+                fen += c == Colours::kWhite ? static_cast<char>(std::toupper(letter)) : letter;
+            }
+        }
+        if (fen.size() == before) fen += '-';
+
+        fen += ' ';
+        fen += st.epSquare ? st.epSquare.to_str() : "-";
+        fen += ' ' + std::to_string(st.halfmove) + ' ' + std::to_string(st.fullmove);
+
+        return fen;
+    }
+
+    std::string Position::to_str() const {
+        std::string str = "\n +---+---+---+---+---+---+---+---+\n";
+
+        for (i32 rank = Ranks::k8; rank >= Ranks::k1; --rank) {
+            for (i32 file = Files::kA; file <= Files::kH; ++file) {
+                str += " | ";
+                str += this->piece_on(Square{rank, file}).to_char();
+            }
+            str += " | ";
+            str += static_cast<char>('1' + rank);
+            str += "\n +---+---+---+---+---+---+---+---+\n";
+        }
+
+        str += "   a   b   c   d   e   f   g   h\n\nFen: " + this->to_fen() + "\n";
+
+        std::ostringstream key;
+        key << std::hex << std::uppercase << this->key();
+        str += "Key: " + key.str() + "\n";
+
+        return str;
+    }
+
+    usize Position::castling_mask() const {
+        const BoardState &st = this->state();
+        usize mask = 0;
+        for (usize c = 0; c < Colour::kNumTypes; ++c) {
+            for (usize side = 0; side < CastlingSides::kNum; ++side) {
+                if (st.castlingRooks[c][side]) mask |= usize{1} << (c * CastlingSides::kNum + side);
+            }
+        }
+        return mask;
+    }
+
+    void Position::put_piece(Piece pc, Square sq) {
+        BoardState &st = this->state_mut();
+        assert(!st.mailbox[sq]);
+
+        st.pieceBBs[pc.type()].set_bit(sq);
+        st.colourBBs[pc.colour()].set_bit(sq);
+        st.mailbox[sq] = pc;
+        st.key ^= zobrist::piece_square(pc, sq);
+    }
+
+    void Position::remove_piece(Square sq) {
+        BoardState &st = this->state_mut();
+        const Piece pc = st.mailbox[sq];
+        assert(pc);
+
+        st.pieceBBs[pc.type()].unset_bit(sq);
+        st.colourBBs[pc.colour()].unset_bit(sq);
+        st.mailbox[sq] = Pieces::kNone;
+        st.key ^= zobrist::piece_square(pc, sq);
+    }
+
+    void Position::move_piece(Square from, Square to) {
+        const Piece pc = this->piece_on(from);
+        this->remove_piece(from);
+        this->put_piece(pc, to);
+    }
+
+    // Only record an en passant square if a pawn of the side to move could actually capture there.
+    // This way, transpositions which differ only by an unusable en passant square share a hash.
+    void Position::set_ep_square(Square sq) {
+        BoardState &st = this->state_mut();
+        if (attacks::get_pawn_attacks(st.stm.flip(), sq) & this->pieces(st.stm, PieceTypes::kPawn)) {
+            st.epSquare = sq;
+            st.key ^= zobrist::en_passant(sq);
+        }
+    }
+
+    void Position::update_check_info() {
+        BoardState &st = this->state_mut();
+        const Colour us = st.stm, them = us.flip();
+        const Square ksq = this->king_sq(us);
+        const Bitboard occ = this->pieces();
+
+        st.checkers = this->attackers_to(ksq, occ) & this->pieces(them);
+        st.pinned = Bitboards::kEmpty;
+
+        const Bitboard snipers = (attacks::get_bishop_attacks(ksq) & this->diagonal_sliders(them))
+                               | (attacks::get_rook_attacks(ksq) & this->orthogonal_sliders(them));
+        for (Square sniper : snipers) {
+            const Bitboard between = attacks::betweenBB[ksq][sniper] & occ;
+            if (between.one_bit_set() && (between & this->pieces(us))) st.pinned |= between;
+        }
+    }
+
+    Bitboard Position::attackers_to(Square sq, Bitboard occ) const {
+        return (attacks::get_pawn_attacks(Colours::kWhite, sq) & this->pieces(Colours::kBlack, PieceTypes::kPawn))
+             | (attacks::get_pawn_attacks(Colours::kBlack, sq) & this->pieces(Colours::kWhite, PieceTypes::kPawn))
+             | (attacks::get_knight_attacks(sq) & this->pieces(PieceTypes::kKnight))
+             | (attacks::get_king_attacks(sq) & this->pieces(PieceTypes::kKing))
+             | (attacks::get_bishop_attacks(sq, occ) & (this->pieces(PieceTypes::kBishop) | this->pieces(PieceTypes::kQueen)))
+             | (attacks::get_rook_attacks(sq, occ) & (this->pieces(PieceTypes::kRook) | this->pieces(PieceTypes::kQueen)));
+    }
+
+    bool Position::is_attacked(Square sq, Colour by, Bitboard occ) const {
+        return (attacks::get_pawn_attacks(by.flip(), sq) & this->pieces(by, PieceTypes::kPawn))
+            || (attacks::get_knight_attacks(sq) & this->pieces(by, PieceTypes::kKnight))
+            || (attacks::get_king_attacks(sq) & this->pieces(by, PieceTypes::kKing))
+            || (attacks::get_bishop_attacks(sq, occ) & this->diagonal_sliders(by))
+            || (attacks::get_rook_attacks(sq, occ) & this->orthogonal_sliders(by));
+    }
+
+    void Position::make_move(Move move) {
+        assert(move != Moves::kNone);
+
+        mStates.push_back(mStates.back());
+        BoardState &st = this->state_mut();
+
+        const Colour us = st.stm, them = us.flip();
+        const Square from = move.from(), to = move.to();
+        const Piece pc = st.mailbox[from];
+
+        st.move = move;
+        st.captured = Pieces::kNone;
+        st.halfmove++;
+        st.pliesFromNull++;
+        if (us == Colours::kBlack) st.fullmove++;
+
+        if (st.epSquare) {
+            st.key ^= zobrist::en_passant(st.epSquare);
+            st.epSquare = Squares::kNone;
+        }
+
+        const usize oldCastling = this->castling_mask();
+        Square epSquare = Squares::kNone;
+
+        switch (move.type()) {
+            case Move::Type::kCastling: {
+                // Castling is encoded as king-takes-rook, so both pieces are lifted before either is placed
+                const Piece rook = st.mailbox[to];
+                this->remove_piece(from);
+                this->remove_piece(to);
+                this->put_piece(pc, move.castle_king_to());
+                this->put_piece(rook, move.castle_rook_to());
+                break;
+            }
+
+            case Move::Type::kEnPassant: {
+                const Square captureSq = Square{from.rank(), to.file()};
+                st.captured = st.mailbox[captureSq];
+                this->remove_piece(captureSq);
+                this->move_piece(from, to);
+                st.halfmove = 0;
+                break;
+            }
+
+            case Move::Type::kNormal:
+            case Move::Type::kPromotion: {
+                if (st.mailbox[to]) {
+                    st.captured = st.mailbox[to];
+                    this->remove_piece(to);
+                    st.halfmove = 0;
+                }
+
+                this->remove_piece(from);
+                this->put_piece(move.type() == Move::Type::kPromotion ? Piece{us, move.promo_type()} : pc, to);
+
+                if (pc.type() == PieceTypes::kPawn) {
+                    st.halfmove = 0;
+                    if ((from.raw() ^ to.raw()) == 16) epSquare = Square{(from.raw() + to.raw()) / 2};
+                }
+                break;
+            }
+        }
+
+        // Moving the king forfeits both rights, and moving or capturing a castling rook forfeits that right
+        for (usize c = 0; c < Colour::kNumTypes; ++c) {
+            for (usize side = 0; side < CastlingSides::kNum; ++side) {
+                const Square rookSq = st.castlingRooks[c][side];
+                if (rookSq == from || rookSq == to) st.castlingRooks[c][side] = Squares::kNone;
+            }
+        }
+        if (pc.type() == PieceTypes::kKing) st.castlingRooks[us].fill(Squares::kNone);
+
+        st.key ^= zobrist::castling(oldCastling) ^ zobrist::castling(this->castling_mask());
+
+        st.stm = them;
+        st.key ^= zobrist::stm();
+
+        if (epSquare) this->set_ep_square(epSquare);
+
+        this->update_check_info();
+    }
+
+    void Position::unmake_move() {
+        assert(mStates.size() > 1);
+        mStates.pop_back();
+    }
+
+    void Position::make_null() {
+        assert(!this->in_check());
+
+        mStates.push_back(mStates.back());
+        BoardState &st = this->state_mut();
+
+        st.move = Moves::kNone;
+        st.captured = Pieces::kNone;
+        st.halfmove++;
+        st.pliesFromNull = 0;
+
+        if (st.epSquare) {
+            st.key ^= zobrist::en_passant(st.epSquare);
+            st.epSquare = Squares::kNone;
+        }
+
+        st.stm = st.stm.flip();
+        st.key ^= zobrist::stm();
+
+        this->update_check_info();
+    }
+
+    void Position::unmake_null() {
+        this->unmake_move();
+    }
+
+    bool Position::is_pseudo_legal(Move move) const {
+        if (move == Moves::kNone || !move.is_canonical()) return false;
+
+        const Colour us = this->stm(), them = us.flip();
+        const Square from = move.from(), to = move.to();
+        const Piece pc = this->piece_on(from);
+        const Bitboard occ = this->pieces();
+
+        if (!pc || pc.colour() != us) return false;
+
+        if (move.type() == Move::Type::kCastling) {
+            if (pc.type() != PieceTypes::kKing || this->in_check()) return false;
+
+            const usize side = to.raw() > from.raw() ? CastlingSides::kKingside : CastlingSides::kQueenside;
+            return this->castling_rook(us, side) == to && this->castling_path_clear(move);
+        }
+
+        if (pc.type() == PieceTypes::kPawn) {
+            const Bitboard promoRank = us == Colours::kWhite ? Bitboards::kRank8 : Bitboards::kRank1;
+            const bool promotion = promoRank.get_bit(to);
+
+            if (move.type() == Move::Type::kEnPassant) return to == this->ep_square() && attacks::get_pawn_attacks(us, from).get_bit(to);
+            if (promotion != (move.type() == Move::Type::kPromotion)) return false;
+
+            if (attacks::get_pawn_attacks(us, from).get_bit(to)) return this->pieces(them).get_bit(to);
+
+            const i32 up = us == Colours::kWhite ? 8 : -8;
+            const Bitboard startRank = us == Colours::kWhite ? Bitboards::kRank2 : Bitboards::kRank7;
+
+            if (to.raw() == from.raw() + up) return !occ.get_bit(to);
+            return to.raw() == from.raw() + 2 * up && startRank.get_bit(from)
+                && !occ.get_bit(to) && !occ.get_bit(Square{from.raw() + up});
+        }
+
+        if (move.type() != Move::Type::kNormal || this->pieces(us).get_bit(to)) return false;
+
+        switch (pc.type().raw()) {
+            case PieceTypes::kKnight.raw(): return attacks::get_knight_attacks(from).get_bit(to);
+            case PieceTypes::kBishop.raw(): return attacks::get_bishop_attacks(from, occ).get_bit(to);
+            case PieceTypes::kRook.raw(): return attacks::get_rook_attacks(from, occ).get_bit(to);
+            case PieceTypes::kQueen.raw(): return attacks::get_queen_attacks(from, occ).get_bit(to);
+            case PieceTypes::kKing.raw(): return attacks::get_king_attacks(from).get_bit(to);
+            default: return false;
+        }
+    }
+
+    bool Position::castling_path_clear(Move move) const {
+        const Square ksq = move.from(), rookSq = move.to();
+
+        // Every square between the king and rook, and between each piece and its destination,
+        // must be empty apart from the castling king and rook themselves
+        const Bitboard occ = this->pieces() ^ Bitboard{ksq} ^ Bitboard{rookSq};
+        const Bitboard path = attacks::betweenBB[ksq][rookSq]
+                            | attacks::betweenBB[ksq][move.castle_king_to()] | Bitboard{move.castle_king_to()}
+                            | attacks::betweenBB[rookSq][move.castle_rook_to()] | Bitboard{move.castle_rook_to()};
+
+        return !(path & occ);
+    }
+
+    bool Position::is_legal(Move move) const {
+        const Colour us = this->stm(), them = us.flip();
+        const Square from = move.from(), to = move.to();
+        const Square ksq = this->king_sq(us);
+        const Bitboard occ = this->pieces();
+
+        if (move.type() == Move::Type::kCastling) {
+            if (this->in_check()) return false;
+
+            // Every square the king passes through, including its destination, must be safe. The castling rook
+            // is lifted first, as in Chess960 it may be shielding one of those squares from an enemy slider.
+            const Square kingTo = move.castle_king_to();
+            const Bitboard path = attacks::betweenBB[from][kingTo] | Bitboard{kingTo};
+            for (Square sq : path) {
+                if (this->is_attacked(sq, them, occ ^ Bitboard{to})) return false;
+            }
+            return true;
+        }
+
+        if (move.type() == Move::Type::kEnPassant) {
+            // En passant removes two pieces from the same rank at once, which pin detection does not account for,
+            // so simply check for slider attacks on the resulting occupancy
+            const Square captureSq = Square{from.rank(), to.file()};
+            const Bitboard after = (occ ^ Bitboard{from} ^ Bitboard{captureSq}) | Bitboard{to};
+            return !(attacks::get_bishop_attacks(ksq, after) & this->diagonal_sliders(them))
+                && !(attacks::get_rook_attacks(ksq, after) & this->orthogonal_sliders(them));
+        }
+
+        if (from == ksq) return !this->is_attacked(to, them, occ ^ Bitboard{from});
+
+        const Bitboard checkers = this->checkers();
+        if (checkers.multiple_bits_set()) return false;
+        if (!checkers.empty() && !((attacks::betweenBB[ksq][checkers.lsb()] | checkers) & Bitboard{to})) return false;
+
+        return !this->pinned().get_bit(from) || attacks::lineBB[from][to].get_bit(ksq);
+    }
+
+    Move Position::parse_move(std::string_view str) const {
+        if (str.size() != 4 && str.size() != 5) return Moves::kNone;
+
+        const auto written_as = [&](Move move, bool chess960) {
+            utils::MDArray<char, Move::kMaxStrSize> buffer;
+            return std::string_view(buffer.data(), move.write(buffer.data(), chess960)) == str;
+        };
+
+        // Rather than rebuilding the move from its squares, find the legal move which is written this way.
+        // Castling may be given as king-takes-rook, or as the king's two-square step in standard chess.
+        MoveList moves;
+        movegen::generate_legal(*this, moves);
+        for (Move move : moves) {
+            if (move.type() != Move::Type::kCastling ? written_as(move, false)
+                                                     : written_as(move, true) || (move.from().file() == Files::kE && written_as(move, false)))
+                return move;
+        }
+
+        return Moves::kNone;
+    }
+
+    bool Position::repeats_earlier(usize idx) const {
+        // Only positions with the same side to move can repeat, and the last one is at least four plies back
+        const usize end = this->reversible_plies(idx);
+        for (usize i = 4; i <= end; i += 2) {
+            if (mStates[idx - i].key == mStates[idx].key) return true;
+        }
+
+        return false;
+    }
+
+    bool Position::is_repetition() const {
+        return this->repeats_earlier(mStates.size() - 1);
+    }
+
+    bool Position::has_upcoming_repetition(i32 ply) const {
+        const usize current = mStates.size() - 1;
+        const usize end = this->reversible_plies(current);
+        if (end < 3) return false;
+
+        const Bitboard occ = this->pieces();
+
+        // A single move by the side to move can only return to a position at an odd distance from here
+        for (usize i = 3; i <= end; i += 2) {
+            const u64 moveKey = this->key() ^ mStates[current - i].key;
+
+            usize slot = cuckoo::h1(moveKey);
+            if (cuckoo::keys[slot] != moveKey) {
+                slot = cuckoo::h2(moveKey);
+                if (cuckoo::keys[slot] != moveKey) continue;
+            }
+
+            const Move move = cuckoo::moves[slot];
+            if (attacks::betweenBB[move.from()][move.to()] & occ) continue;
+
+            if (ply > static_cast<i32>(i)) return true;
+
+            // The cycle reaches back before the root, so we need it to be our move and the position to have
+            // already repeated, otherwise we would be claiming a draw the game history does not support.
+            const Square sq = this->piece_on(move.from()) ? move.from() : move.to();
+            if (this->piece_on(sq).colour() != this->stm()) continue;
+            if (this->repeats_earlier(current - i)) return true;
+        }
+
+        return false;
+    }
+
+    bool Position::has_insufficient_material() const {
+        if (this->pieces(PieceTypes::kPawn) || this->pieces(PieceTypes::kRook) || this->pieces(PieceTypes::kQueen))
+            return false;
+
+        // Bare kings, or a single minor piece on the board
+        return this->pieces().count_bits() <= 3;
+    }
+
+    bool Position::is_draw() const {
+        if (this->halfmove() >= 100) {
+            if (!this->in_check()) return true;
+
+            // Checkmate on the hundredth half-move takes precedence over the fifty-move rule
+            MoveList moves;
+            movegen::generate_legal(*this, moves);
+            return !moves.empty();
+        }
+
+        return this->is_repetition() || this->has_insufficient_material();
+    }
+
+    u64 Position::compute_key() const {
+        const BoardState &st = this->state();
+        u64 key = 0;
+
+        for (Square sq : this->pieces()) key ^= zobrist::piece_square(this->piece_on(sq), sq);
+        if (st.epSquare) key ^= zobrist::en_passant(st.epSquare);
+        if (st.stm == Colours::kBlack) key ^= zobrist::stm();
+        key ^= zobrist::castling(this->castling_mask());
+
+        return key;
+    }
+}
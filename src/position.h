@@ -0,0 +1,262 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "attacks.h"
+#include "bitboard.h"
+#include "core.h"
+#include "move.h"
+#include "types.h"
+#include "utils/mdarray.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace purebred {
+
+    struct CastlingSides {
+        constexpr CastlingSides() = delete;
+
+        static constexpr usize kKingside = 0;
+        static constexpr usize kQueenside = 1;
+
+        static constexpr usize kNum = 2;
+    };
+
+    struct PackedBoard;
+
+    // Everything that is needed to restore a position after unmaking a move.
+    // We use copy-make: making a move pushes a modified copy of the current state, and unmaking simply pops it.
+    struct BoardState {
+        utils::MDArray<Bitboard, PieceType::kNumTypes> pieceBBs;
+        utils::MDArray<Bitboard, Colour::kNumTypes> colourBBs;
+        utils::MDArray<Piece, Square::kNumTypes> mailbox;
+
+        // Castling rights are stored as the square of the rook that may still castle (or Squares::kNone),
+        // which describes both standard chess and Chess960 uniformly.
+        utils::MDArray<Square, Colour::kNumTypes, CastlingSides::kNum> castlingRooks;
+
+        u64 key;
+        Bitboard checkers;
+        Bitboard pinned;
+        Square epSquare;
+        Colour stm;
+        u16 halfmove;
+        u16 fullmove;
+
+        // Plies since the last null move; repetitions are never searched for across one
+        u16 pliesFromNull;
+
+        // The move which led to this state, and the piece it captured.
+        Move move;
+        Piece captured;
+
+        [[nodiscard]] bool operator==(const BoardState &) const = default;
+    };
+
+    class Position {
+    public:
+        [[nodiscard]] static std::optional<Position> from_fen(std::string_view fen);
+        [[nodiscard]] static std::optional<Position> from_packed(const PackedBoard &packed);
+        [[nodiscard]] static Position startpos();
+
+        // As from_packed, but reuses this position's storage, for loops over many records. On failure the position
+        // is left in an unspecified state and must be set up again before use.
+        [[nodiscard]] bool set_packed(const PackedBoard &packed);
+
+        [[nodiscard]] std::string to_fen() const;
+        [[nodiscard]] std::string to_str() const;
+
+        void make_move(Move move);
+        void unmake_move();
+        void make_null();
+        void unmake_null();
+
+        // Checks whether an arbitrary move (e.g. from the TT or a killer slot) is one which move generation
+        // could have produced in this position, without generating anything.
+        [[nodiscard]] bool is_pseudo_legal(Move move) const;
+
+        // Checks whether a pseudo-legal move leaves our own king in check.
+        [[nodiscard]] bool is_legal(Move move) const;
+
+        // Whether the squares the king and rook of a castling move pass through are empty (ignoring both pieces).
+        [[nodiscard]] bool castling_path_clear(Move move) const;
+
+        // Reconstructs a move from its UCI representation. Returns Moves::kNone if the move is not legal.
+        [[nodiscard]] Move parse_move(std::string_view str) const;
+
+        [[nodiscard]] bool is_capture(Move move) const {
+            return move.type() == Move::Type::kEnPassant
+                || (move.type() != Move::Type::kCastling && this->piece_on(move.to()));
+        }
+
+        [[nodiscard]] bool is_noisy(Move move) const {
+            return this->is_capture(move)
+                || (move.type() == Move::Type::kPromotion && move.promo_type() == PieceTypes::kQueen);
+        }
+
+        [[nodiscard]] bool is_draw() const;
+        [[nodiscard]] bool is_repetition() const;
+
+        // Whether the side to move has a reversible move which repeats an earlier position.
+        // `ply` is the distance from the search root; cycles that extend past the root are only
+        // claimed if the position they return to has already occurred twice.
+        [[nodiscard]] bool has_upcoming_repetition(i32 ply) const;
+        [[nodiscard]] bool has_insufficient_material() const;
+
+        // Recomputes the hash of the position from scratch; used to validate the incrementally updated one.
+        [[nodiscard]] u64 compute_key() const;
+
+        [[nodiscard]] Bitboard attackers_to(Square sq, Bitboard occ) const;
+        [[nodiscard]] bool is_attacked(Square sq, Colour by, Bitboard occ) const;
+
+        [[nodiscard]] const BoardState &state() const {
+            return mStates.back();
+        }
+
+        // The state `ply` plies after the position was set up, for 0 <= ply <= game_ply()
+        [[nodiscard]] const BoardState &state_at(usize ply) const {
+            return mStates[ply];
+        }
+
+        [[nodiscard]] Colour stm() const {
+            return this->state().stm;
+        }
+
+        [[nodiscard]] Piece piece_on(Square sq) const {
+            return this->state().mailbox[sq];
+        }
+
+        [[nodiscard]] Bitboard pieces() const {
+            return this->state().colourBBs[Colours::kWhite] | this->state().colourBBs[Colours::kBlack];
+        }
+
+        [[nodiscard]] Bitboard pieces(Colour c) const {
+            return this->state().colourBBs[c];
+        }
+
+        [[nodiscard]] Bitboard pieces(PieceType pt) const {
+            return this->state().pieceBBs[pt];
+        }
+
+        [[nodiscard]] Bitboard pieces(Colour c, PieceType pt) const {
+            return this->pieces(c) & this->pieces(pt);
+        }
+
+        [[nodiscard]] Bitboard diagonal_sliders(Colour c) const {
+            return this->pieces(c) & (this->pieces(PieceTypes::kBishop) | this->pieces(PieceTypes::kQueen));
+        }
+
+        [[nodiscard]] Bitboard orthogonal_sliders(Colour c) const {
+            return this->pieces(c) & (this->pieces(PieceTypes::kRook) | this->pieces(PieceTypes::kQueen));
+        }
+
+        [[nodiscard]] Square king_sq(Colour c) const {
+            return this->pieces(c, PieceTypes::kKing).lsb();
+        }
+
+        [[nodiscard]] Bitboard checkers() const {
+            return this->state().checkers;
+        }
+
+        [[nodiscard]] bool in_check() const {
+            return !this->checkers().empty();
+        }
+
+        [[nodiscard]] Bitboard pinned() const {
+            return this->state().pinned;
+        }
+
+        [[nodiscard]] Square ep_square() const {
+            return this->state().epSquare;
+        }
+
+        [[nodiscard]] Square castling_rook(Colour c, usize side) const {
+            return this->state().castlingRooks[c][side];
+        }
+
+        [[nodiscard]] usize castling_mask() const;
+
+        [[nodiscard]] u64 key() const {
+            return this->state().key;
+        }
+
+        [[nodiscard]] u16 halfmove() const {
+            return this->state().halfmove;
+        }
+
+        [[nodiscard]] u16 fullmove() const {
+            return this->state().fullmove;
+        }
+
+        [[nodiscard]] Move last_move() const {
+            return this->state().move;
+        }
+
+        [[nodiscard]] Piece last_captured() const {
+            return this->state().captured;
+        }
+
+        // Number of plies that have been made since the position was set up
+        [[nodiscard]] usize game_ply() const {
+            return mStates.size() - 1;
+        }
+
+        // Makes room for this many further moves, so that making them never allocates
+        void reserve(usize plies) {
+            mStates.reserve(mStates.size() + plies);
+        }
+
+        // True if the side to move has any pieces besides pawns and king, which is used to guard null move pruning
+        [[nodiscard]] bool has_non_pawn_material(Colour c) const {
+            return !(this->pieces(c) & ~this->pieces(PieceTypes::kPawn) & ~this->pieces(PieceTypes::kKing)).empty();
+        }
+
+    private:
+        std::vector<BoardState> mStates;
+
+        // A position with no pieces and default state, for the constructors to fill in
+        [[nodiscard]] static Position empty();
+        void reset();
+
+        BoardState &state_mut() {
+            return mStates.back();
+        }
+
+        void put_piece(Piece pc, Square sq);
+        void remove_piece(Square sq);
+        void move_piece(Square from, Square to);
+
+        // Number of earlier plies that a repetition of the current position could lie within
+        [[nodiscard]] usize reversible_plies(usize idx) const {
+            return std::min<usize>({mStates[idx].halfmove, mStates[idx].pliesFromNull, idx});
+        }
+
+        // Whether the position at mStates[idx] occurred before within the reversible plies preceding it
+        [[nodiscard]] bool repeats_earlier(usize idx) const;
+
+        void set_ep_square(Square sq);
+        void update_check_info();
+    };
+}
@@ -0,0 +1,986 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "search.h"
+
+#include "eval.h"
+#include "mate.h"
+#include "movepick.h"
+#include "params.h"
+#include "utils/line_buffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace purebred::search {
+
+    namespace {
+        constexpr i64 kMoveOverhead = 10;
+        constexpr i32 kHistoryMax = 16384;
+
+        [[nodiscard]] i32 compute_lmr(usize depth, usize moves) {
+            return static_cast<i32>(params::lmrBase() / 100.0 + std::log(depth) * std::log(moves) / (params::lmrDivisor() / 100.0));
+        }
+
+        const utils::MDArray<i32, kMaxDepth + 1, kMaxMoves> kLmrTable = []() {
+            utils::MDArray<i32, kMaxDepth + 1, kMaxMoves> table{};
+            for (usize depth = 1; depth <= kMaxDepth; ++depth) {
+                for (usize moves = 1; moves < kMaxMoves; ++moves) table[depth][moves] = compute_lmr(depth, moves);
+            }
+            return table;
+        }();
+
+        // The table is built before any option can be set, so tuning builds compute reductions directly
+        [[nodiscard]] i32 lmr_reduction(i32 depth, i32 moves) {
+            const usize clampedMoves = std::min<usize>(static_cast<usize>(moves), kMaxMoves - 1);
+            if constexpr (tune::kEnabled) return compute_lmr(static_cast<usize>(depth), clampedMoves);
+            return kLmrTable[depth][clampedMoves];
+        }
+
+        // Sorts root moves by descending score, keeping the previous order among ties, in place: std::stable_sort
+        // may allocate a buffer, and there are few enough root moves for insertion to be as fast
+        template <typename It>
+        void sort_root_moves(It begin, It end) {
+            for (It it = begin; it != end; ++it) {
+                const It slot = std::upper_bound(begin, it, *it, [](const RootMove &a, const RootMove &b) { return a.score > b.score; });
+                std::rotate(slot, it, it + 1);
+            }
+        }
+
+        [[nodiscard]] bool is_mate_score(Score score) {
+            return std::abs(score) >= Scores::kMateInMaxPly;
+        }
+
+        // Root moves are only announced as they are searched once a search has run this long (milliseconds)
+        constexpr i64 kCurrmoveDelay = 3000;
+
+        // Depth skipping patterns for staggered workers: the one with index i skips a depth if
+        // (depth + phase) / size is odd, so that between them they cover the iterations unevenly
+        constexpr std::array<i32, 20> kSkipSize = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+        constexpr std::array<i32, 20> kSkipPhase = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+        void put_score(utils::LineBuffer &line, Score score) {
+            if (score >= Scores::kMateInMaxPly) line << "mate " << (Scores::kMate - score + 1) / 2;
+            else if (score <= -Scores::kMateInMaxPly) line << "mate " << -(Scores::kMate + score) / 2;
+            else line << "cp " << score;
+        }
+
+        void put_move(utils::LineBuffer &line, Move move, bool chess960) {
+            line.write(Move::kMaxStrSize, [&](char *out) { return move.write(out, chess960); });
+        }
+
+        // An info line for a result which did not come straight from the main worker's iterations
+        void report_result(const SearchResult &result, i64 elapsed, bool chess960) {
+            utils::LineBuffer line;
+            line << "info depth " << result.depth << " seldepth " << result.seldepth << " multipv 1 score ";
+            put_score(line, result.score);
+            line << " nodes " << result.nodes << " nps " << result.nodes * 1000 / static_cast<u64>(std::max<i64>(elapsed, 1))
+                 << " time " << elapsed << " pv";
+            for (Move move : result.pv) {
+                line << ' ';
+                put_move(line, move, chess960);
+            }
+            line.flush();
+        }
+    }
+
+    void TimeManager::start(const Limits &limits, Colour stm) {
+        mStart = std::chrono::steady_clock::now();
+        mTimed = false;
+
+        if (limits.infinite) return;
+
+        if (limits.movetime) {
+            mTimed = true;
+            mSoft = mHard = std::max<i64>(limits.movetime - kMoveOverhead, 1);
+            return;
+        }
+
+        if (limits.time[stm]) {
+            mTimed = true;
+            const i64 available = std::max<i64>(limits.time[stm] - kMoveOverhead, 1);
+            const i64 movesToGo = limits.movestogo ? std::clamp(limits.movestogo, 1, 50) : 20;
+
+            mSoft = std::min(available / movesToGo + limits.inc[stm] * 3 / 4, available * 4 / 5);
+            mHard = std::min(mSoft * 3, available * 4 / 5);
+        }
+    }
+
+    void Worker::clear() {
+        mHistory.fill(0);
+    }
+
+    const SearchResult &Worker::run(const Position &pos, const Limits &limits, Role role) {
+        mPos = pos;
+        mPos.reserve(kMaxPly + 1);
+        mLimits = limits;
+        mRole = role;
+        mPondering = role == Role::kMain && limits.ponder;
+        mNodes.store(0, std::memory_order_relaxed);
+        mTime.start(limits, pos.stm());
+        mAccumulators.reset(pos);
+
+        for (auto &entry : mStack) {
+            entry.pv.clear();
+            entry.move = Moves::kNone;
+            entry.killer = Moves::kNone;
+            entry.staticEval = Scores::kNone;
+            entry.excluded = Moves::kNone;
+        }
+
+        MoveList legal;
+        movegen::generate_legal(pos, legal);
+
+        mRootMoves.clear();
+        for (Move move : legal) {
+            RootMove rm;
+            rm.move = move;
+            mRootMoves.push(rm);
+        }
+        this->order_root_moves();
+        this->decay_history();
+
+        const usize multiPV = std::clamp<usize>(limits.multiPV, 1, std::max<usize>(mRootMoves.size(), 1));
+        SearchResult &result = mResult;
+        result = {};
+
+        for (i32 depth = 1; depth <= std::min(limits.depth, kMaxDepth); ++depth) {
+            if (this->skips_depth(depth)) continue;
+
+            for (RootMove &rm : mRootMoves) rm.previousScore = rm.score;
+
+            for (mPVIdx = 0; mPVIdx < multiPV; ++mPVIdx) {
+                mSeldepth = 0;
+
+                const Score prevScore = mPVIdx < mRootMoves.size() ? mRootMoves[mPVIdx].previousScore : 0;
+
+                // Aspiration windows: search a narrow window around the previous score, widening on failure
+                Score delta = params::aspDelta();
+                Score alpha = depth >= 4 ? std::max(prevScore - delta, -Scores::kInf) : -Scores::kInf;
+                Score beta = depth >= 4 ? std::min(prevScore + delta, Scores::kInf) : Scores::kInf;
+
+                while (true) {
+                    const Score score = this->negamax<true>(depth, alpha, beta, 0, false);
+                    if (mStop.load(std::memory_order_relaxed)) break;
+
+                    if (score <= alpha) {
+                        beta = (alpha + beta) / 2;
+                        alpha = std::max(score - delta, -Scores::kInf);
+                    } else if (score >= beta) {
+                        beta = std::min(score + delta, Scores::kInf);
+                    } else {
+                        break;
+                    }
+
+                    delta += delta / 2;
+                }
+
+                // Lines found in this iteration stay in front; the stable sort keeps the previous order among ties
+                sort_root_moves(mRootMoves.begin() + static_cast<std::ptrdiff_t>(mPVIdx), mRootMoves.end());
+
+                if (mStop.load(std::memory_order_relaxed)) break;
+            }
+
+            // An interrupted iteration is only trusted if it is the first one, so that we always have a move
+            if (mStop.load(std::memory_order_relaxed) && result.bestMove != Moves::kNone) break;
+
+            if (!mRootMoves.empty()) {
+                const RootMove &best = mRootMoves[0];
+                result.bestMove = best.move;
+                result.score = best.score;
+                result.seldepth = best.seldepth;
+                result.pv = best.pv;
+            } else {
+                result.score = pos.in_check() ? -Scores::kMate : Scores::kDraw;
+            }
+
+            result.depth = depth;
+            result.nodes = this->nodes();
+
+            if (mRole == Role::kMain) this->report(depth, multiPV);
+            if (mStop.load(std::memory_order_relaxed) || mRootMoves.empty()) break;
+
+            this->check_ponderhit();
+            if (mRole != Role::kHelper && !mPondering && mTime.soft_expired()) break;
+        }
+
+        result.nodes = this->nodes();
+        return result;
+    }
+
+    Score Worker::evaluate() {
+        mStats.inc(stats::Counter::kEvals);
+        if (nnue::loaded()) return mAccumulators.evaluate(mPos, mStats);
+        return eval::evaluate(mPos);
+    }
+
+    void Worker::decay_history() {
+        // What was learned on earlier moves of the game is still mostly relevant, but should not outweigh
+        // what this search finds
+        for (auto &colour : mHistory) {
+            for (auto &from : colour) {
+                for (i16 &entry : from) entry = static_cast<i16>(entry / 2);
+            }
+        }
+    }
+
+    void Worker::order_root_moves() {
+        // Before the first iteration, order the root moves by what the TT still knows about the positions they
+        // lead to, which during a game is mostly the subtree searched on the previous move. Moves it knows
+        // nothing about keep the move generation order after them.
+        TTEntry entry;
+        const Move ttMove = mTT.probe(mPos.key(), entry) ? entry.move : Moves::kNone;
+
+        for (RootMove &rm : mRootMoves) {
+            mPos.make_move(rm.move);
+            const bool hit = mTT.probe(mPos.key(), entry) && entry.bound() != Bound::kNone;
+            mPos.unmake_move();
+
+            rm.score = rm.move == ttMove ? Scores::kInf : hit ? -score_from_tt(entry.score, 1) : -Scores::kInf;
+        }
+
+        sort_root_moves(mRootMoves.begin(), mRootMoves.end());
+        for (RootMove &rm : mRootMoves) rm.score = -Scores::kInf;
+    }
+
+    void Worker::check_ponderhit() {
+        // The opponent's thinking time is not ours, so the clock starts when they play the expected move
+        if (mPondering && !(mPool && mPool->pondering())) {
+            mPondering = false;
+            mTime.restart();
+        }
+    }
+
+    bool Worker::should_stop() {
+        if (mStop.load(std::memory_order_relaxed)) return true;
+        if (mRole == Role::kHelper) return false;
+
+        this->check_ponderhit();
+        if (mPondering) return false;
+
+        if ((mLimits.nodes && this->nodes() >= mLimits.nodes) || ((this->nodes() & 1023) == 0 && mTime.hard_expired())) {
+            mStop.store(true, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool Worker::skips_depth(i32 depth) const {
+        if (mStagger == 0) return false;
+
+        const usize idx = (mStagger - 1) % kSkipSize.size();
+        return (depth + kSkipPhase[idx]) / kSkipSize[idx] % 2 != 0;
+    }
+
+    void Worker::update_history(Move move, i32 bonus) {
+        i16 &entry = mHistory[mPos.stm()][move.from()][move.to()];
+
+        // History gravity: scale the bonus down as the entry approaches its limit, so entries never saturate
+        const i32 clamped = std::clamp(bonus, -kHistoryMax, kHistoryMax);
+        entry = static_cast<i16>(entry + clamped - entry * std::abs(clamped) / kHistoryMax);
+    }
+
+    template <bool kPV>
+    Score Worker::negamax(i32 depth, Score alpha, Score beta, i32 ply, bool cutnode) {
+        const bool root = ply == 0;
+        const bool inCheck = mPos.in_check();
+
+        // Check extension
+        if (inCheck) depth++;
+
+        if (depth <= 0) return this->qsearch<kPV>(alpha, beta, ply);
+
+        StackEntry &ss = mStack[ply];
+        ss.pv.clear();
+        mStats.inc(stats::Counter::kNodes);
+        mTrace.node(trace::Event::kNode, mPos.key(), depth, ply, alpha, beta);
+
+        if (kPV) mSeldepth = std::max(mSeldepth, ply + 1);
+
+        if (!root) {
+            if (this->should_stop()) return 0;
+            if (mPos.is_draw()) {
+                mTrace.node(trace::Event::kDraw, mPos.key(), depth, ply, alpha, beta, Scores::kDraw);
+                return Scores::kDraw;
+            }
+            if (ply >= static_cast<i32>(kMaxPly) - 1) return inCheck ? Scores::kDraw : this->evaluate();
+
+            // If we can repeat a position with our next move, we can always do at least as well as a draw
+            if (alpha < Scores::kDraw && mPos.has_upcoming_repetition(ply)) {
+                alpha = Scores::kDraw;
+                if (alpha >= beta) return alpha;
+            }
+
+            // Mate distance pruning: even mating right now cannot beat a shorter mate found elsewhere
+            alpha = std::max(alpha, -Scores::kMate + ply);
+            beta = std::min(beta, Scores::kMate - ply - 1);
+            if (alpha >= beta) return alpha;
+        }
+
+        const Move excluded = ss.excluded;
+        const bool excludedSearch = excluded != Moves::kNone;
+
+        TTEntry ttEntry;
+        const bool ttHit = mTT.probe(mPos.key(), ttEntry);
+        mStats.inc(stats::Counter::kTTProbes);
+        if (ttHit) mStats.inc(stats::Counter::kTTHits);
+        const Move ttMove = ttHit ? ttEntry.move : Moves::kNone;
+        const Score ttScore = ttHit ? score_from_tt(ttEntry.score, ply) : Scores::kNone;
+
+        // The entry describes the full node, so it says nothing about the node without the excluded move
+        if (!kPV && !excludedSearch && ttHit && ttEntry.depth >= depth
+            && (ttEntry.bound() == Bound::kExact
+                || (ttEntry.bound() == Bound::kLower && ttScore >= beta)
+                || (ttEntry.bound() == Bound::kUpper && ttScore <= alpha))) {
+            mStats.inc(stats::Counter::kTTCutoffs);
+            mTrace.node(trace::Event::kTTCutoff, mPos.key(), depth, ply, alpha, beta, ttScore);
+            return ttScore;
+        }
+
+        Score staticEval = Scores::kNone;
+        if (!inCheck) staticEval = ttHit && ttEntry.staticEval != Scores::kNone ? ttEntry.staticEval : this->evaluate();
+        ss.staticEval = staticEval;
+
+        const bool improving = !inCheck && ply >= 2 && mStack[ply - 2].staticEval != Scores::kNone
+                            && staticEval > mStack[ply - 2].staticEval;
+
+        if (!kPV && !inCheck && !excludedSearch) {
+            // Reverse futility pruning: if we are far above beta, assume we will stay there
+            if (depth <= params::rfpDepth() && !is_mate_score(beta)) {
+                mStats.inc(stats::Counter::kRfpAttempts);
+                if (staticEval - params::rfpMargin() * (depth - improving) >= beta) {
+                    mStats.inc(stats::Counter::kRfpPrunes);
+                    mTrace.node(trace::Event::kRfp, mPos.key(), depth, ply, alpha, beta, staticEval);
+                    return staticEval;
+                }
+            }
+
+            // Null move pruning: if passing still fails high, a real move almost certainly would too
+            if (depth >= params::nmpMinDepth() && staticEval >= beta && mPos.last_move() != Moves::kNone
+                && mPos.has_non_pawn_material(mPos.stm())) {
+                const i32 reduction = params::nmpBase() + depth / params::nmpDivisor();
+                mStats.inc(stats::Counter::kNmpAttempts);
+
+                ss.move = Moves::kNone;
+                mPos.make_null();
+                const Score score = -this->negamax<false>(depth - reduction, -beta, -beta + 1, ply + 1, !cutnode);
+                mPos.unmake_null();
+
+                if (mStop.load(std::memory_order_relaxed)) return 0;
+                if (score >= beta) {
+                    mStats.inc(stats::Counter::kNmpCutoffs);
+                    mTrace.node(trace::Event::kNmp, mPos.key(), depth, ply, alpha, beta, score);
+                    return is_mate_score(score) ? beta : score;
+                }
+            }
+        }
+
+        MovePicker picker{mPos, ttMove, ss.killer, mHistory, false};
+        MoveList quietsTried;
+
+        Score bestScore = -Scores::kInf;
+        Move bestMove = Moves::kNone;
+        Bound bound = Bound::kUpper;
+        i32 movesSearched = 0;
+
+        // The root searches its moves in the order of the previous iteration's results, skipping those which
+        // already produced an earlier MultiPV line; every other node uses the move picker.
+        usize rootIdx = mPVIdx;
+        const auto next_move = [&]() {
+            if (!root) return picker.next();
+            return rootIdx < mRootMoves.size() ? mRootMoves[rootIdx++].move : Moves::kNone;
+        };
+
+        for (Move move = next_move(); move != Moves::kNone; move = next_move()) {
+            RootMove *rootMove = root ? &mRootMoves[rootIdx - 1] : nullptr;
+            if (move == excluded || (!root && !mPos.is_legal(move))) continue;
+
+            const bool quiet = !mPos.is_noisy(move);
+
+            if (!root && bestScore > -Scores::kMateInMaxPly && quiet) {
+                // Late move pruning: at low depth, quiets this late in the list are very unlikely to matter
+                if (movesSearched >= params::lmpBase() + depth * depth / (2 - improving)) {
+                    mStats.inc(stats::Counter::kLmpPrunes);
+                    mTrace.move(trace::Event::kLmp, mPos.key(), depth, ply, alpha, beta, move, movesSearched + 1);
+                    continue;
+                }
+
+                // Futility pruning: skip quiets which cannot plausibly raise alpha
+                if (!inCheck && depth <= params::fpDepth() && staticEval + params::fpBase() + params::fpScale() * depth <= alpha) {
+                    mStats.inc(stats::Counter::kFutilityPrunes);
+                    mTrace.move(trace::Event::kFutility, mPos.key(), depth, ply, alpha, beta, move, movesSearched + 1);
+                    continue;
+                }
+            }
+
+            // Singular extensions: if every other move fails low against a margin below the TT score, the TT move
+            // is the only good one and is searched deeper. If instead the reduced search without it still beats
+            // beta, several moves do, and the node can be cut (multi-cut).
+            i32 extension = 0;
+            if (!root && !excludedSearch && move == ttMove && depth >= params::seMinDepth() && ttEntry.depth >= depth - 3
+                && ttEntry.bound() != Bound::kUpper && !is_mate_score(ttScore)) {
+                const Score singularBeta = ttScore - params::seMargin() * depth;
+                mStats.inc(stats::Counter::kSingularSearches);
+
+                ss.excluded = move;
+                const Score singularScore = this->negamax<false>((depth - 1) / 2, singularBeta - 1, singularBeta, ply, cutnode);
+                ss.excluded = Moves::kNone;
+
+                if (mStop.load(std::memory_order_relaxed)) return 0;
+
+                if (singularScore < singularBeta) {
+                    mStats.inc(stats::Counter::kSingularExtensions);
+                    extension = 1;
+                } else if (singularBeta >= beta) {
+                    mStats.inc(stats::Counter::kMultiCuts);
+                    return singularBeta;
+                } else if (ttScore >= beta) {
+                    // The TT move is not alone in failing high, so it need not be searched as deeply
+                    extension = -1;
+                }
+            }
+
+            if (root && mRole == Role::kMain && mTime.elapsed() >= kCurrmoveDelay) this->report_currmove(depth, move, rootIdx);
+
+            ss.move = move;
+            mPos.make_move(move);
+            mTT.prefetch(mPos.key());
+            const u64 nodesBefore = this->nodes();
+            mNodes.fetch_add(1, std::memory_order_relaxed);
+            movesSearched++;
+
+            const i32 newDepth = depth - 1 + extension;
+            i32 reduction = 0;
+            u8 traceFlags = 0;
+            Score score;
+
+            if (movesSearched == 1) {
+                score = -this->negamax<kPV>(newDepth, -beta, -alpha, ply + 1, false);
+            } else {
+                // Late move reductions: search later moves at reduced depth with a null window first
+                if (depth >= 3 && movesSearched > 1 + root && quiet) {
+                    reduction = lmr_reduction(depth, movesSearched);
+                    reduction -= kPV;
+                    reduction += !improving;
+                    reduction += cutnode;
+                    reduction = std::clamp(reduction, 0, newDepth - 1);
+                }
+
+                if (reduction > 0) mStats.inc(stats::Counter::kLmrSearches);
+                score = -this->negamax<false>(newDepth - reduction, -alpha - 1, -alpha, ply + 1, true);
+
+                if (score > alpha && reduction > 0) {
+                    mStats.inc(stats::Counter::kLmrResearches);
+                    traceFlags |= trace::kReducedResearch;
+                    score = -this->negamax<false>(newDepth, -alpha - 1, -alpha, ply + 1, !cutnode);
+                }
+
+                if (kPV && score > alpha && score < beta) {
+                    traceFlags |= trace::kPVResearch;
+                    score = -this->negamax<true>(newDepth, -beta, -alpha, ply + 1, false);
+                }
+            }
+
+            mPos.unmake_move();
+            mTrace.move(trace::Event::kMove, mPos.key(), depth, ply, alpha, beta, move, movesSearched, reduction, traceFlags, score);
+
+            if (mStop.load(std::memory_order_relaxed)) return 0;
+
+            if (root) {
+                rootMove->nodes += this->nodes() - nodesBefore;
+
+                // Only the first move and moves which raise alpha get an exact score and a PV of their own
+                if (movesSearched == 1 || score > alpha) {
+                    rootMove->score = score;
+                    rootMove->seldepth = mSeldepth;
+                    rootMove->pv.clear();
+                    rootMove->pv.push(move);
+                    for (Move child : mStack[1].pv) rootMove->pv.push(child);
+                } else {
+                    rootMove->score = -Scores::kInf;
+                }
+            }
+
+            if (score > bestScore) {
+                bestScore = score;
+
+                if (score > alpha) {
+                    bestMove = move;
+                    alpha = score;
+                    bound = Bound::kExact;
+
+                    if (kPV) {
+                        ss.pv.clear();
+                        ss.pv.push(move);
+                        for (Move child : mStack[ply + 1].pv) ss.pv.push(child);
+                    }
+
+                    if (score >= beta) {
+                        bound = Bound::kLower;
+                        if (!root) mStats.cutoff(movesSearched, picker.source());
+
+                        if (quiet) {
+                            const i32 bonus = std::min(params::histBonusQuad() * depth * depth + params::histBonusLinear() * depth,
+                                                       params::histBonusMax());
+                            ss.killer = move;
+                            this->update_history(move, bonus);
+                            for (Move tried : quietsTried) this->update_history(tried, -bonus);
+                        }
+
+                        break;
+                    }
+                }
+            }
+
+            if (quiet && quietsTried.size() < quietsTried.max_size()) quietsTried.push(move);
+        }
+
+        // Without the excluded move there may be nothing left to search, which says nothing about mate or stalemate
+        if (movesSearched == 0) return excludedSearch ? alpha : inCheck ? -Scores::kMate + ply : Scores::kDraw;
+
+        if (!excludedSearch) mTT.store(mPos.key(), bestMove, score_to_tt(bestScore, ply), staticEval, depth, bound);
+        return bestScore;
+    }
+
+    template <bool kPV>
+    Score Worker::qsearch(Score alpha, Score beta, i32 ply) {
+        if (kPV) mSeldepth = std::max(mSeldepth, ply + 1);
+        mStack[ply].pv.clear();
+        mStats.inc(stats::Counter::kQNodes);
+
+        if (this->should_stop()) return 0;
+        if (mPos.is_draw()) return Scores::kDraw;
+
+        if (alpha < Scores::kDraw && mPos.has_upcoming_repetition(ply)) {
+            alpha = Scores::kDraw;
+            if (alpha >= beta) return alpha;
+        }
+
+        const bool inCheck = mPos.in_check();
+        if (ply >= static_cast<i32>(kMaxPly) - 1) return inCheck ? Scores::kDraw : this->evaluate();
+
+        TTEntry ttEntry;
+        const bool ttHit = mTT.probe(mPos.key(), ttEntry);
+        mStats.inc(stats::Counter::kTTProbes);
+        if (ttHit) mStats.inc(stats::Counter::kTTHits);
+        const Score ttScore = ttHit ? score_from_tt(ttEntry.score, ply) : Scores::kNone;
+
+        if (!kPV && ttHit
+            && (ttEntry.bound() == Bound::kExact
+                || (ttEntry.bound() == Bound::kLower && ttScore >= beta)
+                || (ttEntry.bound() == Bound::kUpper && ttScore <= alpha))) {
+            mStats.inc(stats::Counter::kTTCutoffs);
+            return ttScore;
+        }
+
+        Score staticEval = Scores::kNone;
+        Score bestScore = -Scores::kInf;
+
+        // Stand pat: when not in check, the side to move may decline all captures
+        if (!inCheck) {
+            staticEval = ttHit && ttEntry.staticEval != Scores::kNone ? ttEntry.staticEval : this->evaluate();
+            bestScore = staticEval;
+            if (bestScore >= beta) return bestScore;
+            alpha = std::max(alpha, bestScore);
+        }
+
+        // When in check we must consider every evasion, otherwise only noisy moves
+        MovePicker picker{mPos, ttHit ? ttEntry.move : Moves::kNone, Moves::kNone, mHistory, !inCheck};
+        Move bestMove = Moves::kNone;
+        Bound bound = Bound::kUpper;
+        i32 movesSearched = 0;
+
+        for (Move move = picker.next(); move != Moves::kNone; move = picker.next()) {
+            if (!mPos.is_legal(move)) continue;
+
+            mPos.make_move(move);
+            mTT.prefetch(mPos.key());
+            mNodes.fetch_add(1, std::memory_order_relaxed);
+            movesSearched++;
+
+            const Score score = -this->qsearch<kPV>(-beta, -alpha, ply + 1);
+
+            mPos.unmake_move();
+
+            if (mStop.load(std::memory_order_relaxed)) return 0;
+
+            if (score > bestScore) {
+                bestScore = score;
+
+                if (score > alpha) {
+                    bestMove = move;
+                    alpha = score;
+                    bound = Bound::kExact;
+
+                    if (kPV) {
+                        mStack[ply].pv.clear();
+                        mStack[ply].pv.push(move);
+                        for (Move child : mStack[ply + 1].pv) mStack[ply].pv.push(child);
+                    }
+
+                    if (score >= beta) {
+                        bound = Bound::kLower;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (inCheck && movesSearched == 0) return -Scores::kMate + ply;
+
+        mTT.store(mPos.key(), bestMove, score_to_tt(bestScore, ply), staticEval, 0, bound);
+        return bestScore;
+    }
+
+    void Worker::report(i32 depth, usize multiPV) const {
+        const i64 elapsed = mTime.elapsed();
+        const u64 nodes = mPool ? mPool->nodes() : this->nodes();
+
+        for (usize i = 0; i < std::max<usize>(multiPV, 1); ++i) {
+            const bool searched = i < mRootMoves.size();
+            const Score score = searched ? mRootMoves[i].score : (mPos.in_check() ? -Scores::kMate : Scores::kDraw);
+
+            utils::LineBuffer line;
+            line << "info depth " << depth << " seldepth " << (searched ? mRootMoves[i].seldepth : 0) << " multipv " << i + 1 << " score ";
+            put_score(line, score);
+            line << " nodes " << nodes << " nps " << nodes * 1000 / static_cast<u64>(std::max<i64>(elapsed, 1))
+                 << " hashfull " << mTT.hashfull() << " time " << elapsed << " pv";
+
+            if (searched) {
+                for (Move move : mRootMoves[i].pv) {
+                    line << ' ';
+                    put_move(line, move, mLimits.chess960);
+                }
+            }
+            line.flush();
+        }
+    }
+
+    void Worker::report_currmove(i32 depth, Move move, usize number) const {
+        utils::LineBuffer line;
+        line << "info depth " << depth << " currmove ";
+        put_move(line, move, mLimits.chess960);
+        line << " currmovenumber " << number;
+        line.flush();
+    }
+
+    ThreadPool::ThreadPool(TranspositionTable &tt) : mTT(tt) {
+        this->set_threads(1);
+    }
+
+    ThreadPool::~ThreadPool() {
+        this->stop();
+        this->wait();
+        this->join_threads();
+    }
+
+    void ThreadPool::set_threads(usize count) {
+        this->wait();
+        this->join_threads();
+
+        // Deterministic helpers are tied to their private state, so both are rebuilt together
+        mWorkers.clear();
+        mPrivate.clear();
+        count = std::max<usize>(count, 1);
+        for (usize i = 0; i < count; ++i) {
+            if (!mDeterministic || i == 0) {
+                mWorkers.push_back(std::make_unique<Worker>(mTT, mStop, this));
+                continue;
+            }
+
+            PrivateState &state = *mPrivate.emplace_back(std::make_unique<PrivateState>(this->private_hash(count)));
+            mWorkers.push_back(std::make_unique<Worker>(state.tt, state.stop, this, i));
+        }
+        this->clear();
+
+        for (usize i = 0; i < count; ++i) mThreads.emplace_back(&ThreadPool::thread_loop, this, i);
+    }
+
+    void ThreadPool::thread_loop(usize idx) {
+        u64 done = 0;
+        while (true) {
+            {
+                std::unique_lock lock{mMutex};
+                mWake.wait(lock, [&]() { return mQuit || (idx == 0 ? mMainJobs : mHelperJobs) != done; });
+                if (mQuit) return;
+                done = idx == 0 ? mMainJobs : mHelperJobs;
+            }
+
+            if (idx == 0) this->main_search();
+            else if (mDeterministic) (void)mWorkers[idx]->run(*mJobPos, this->share_limits(*mJobLimits, idx), Worker::Role::kSilent);
+            else (void)mWorkers[idx]->run(*mJobPos, *mJobLimits, Worker::Role::kHelper);
+
+            {
+                std::lock_guard lock{mMutex};
+                if (idx == 0) mMainBusy = false;
+                else --mHelpersBusy;
+            }
+            mDone.notify_all();
+        }
+    }
+
+    void ThreadPool::join_threads() {
+        {
+            std::lock_guard lock{mMutex};
+            mQuit = true;
+        }
+        mWake.notify_all();
+        for (auto &thread : mThreads) thread.join();
+
+        // New threads start counting from zero, so that none of them mistakes an old search for a new one
+        mThreads.clear();
+        mQuit = false;
+        mMainJobs = 0;
+        mHelperJobs = 0;
+    }
+
+    void ThreadPool::set_deterministic(bool deterministic) {
+        this->wait();
+        if (deterministic == mDeterministic) return;
+
+        mDeterministic = deterministic;
+        this->set_threads(mWorkers.size());
+    }
+
+    void ThreadPool::set_hash(usize megabytes) {
+        this->wait();
+        mHashMB = megabytes;
+        mTT.resize(megabytes);
+        for (auto &state : mPrivate) state->tt.resize(this->private_hash(mWorkers.size()));
+        mSolver.reset();
+    }
+
+    void ThreadPool::prepare(const Limits &limits) {
+        mTT.new_search();
+        mStop.store(false, std::memory_order_relaxed);
+        mPondering.store(limits.ponder, std::memory_order_relaxed);
+
+        for (auto &state : mPrivate) {
+            state->tt.new_search();
+            state->stop.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void ThreadPool::start(const Position &pos, const Limits &limits) {
+        this->wait();
+        this->prepare(limits);
+
+        // Assigning into the same position every time reuses its storage
+        mRootPos = pos;
+        mRootLimits = limits;
+        {
+            std::lock_guard lock{mMutex};
+            mMainBusy = true;
+            ++mMainJobs;
+        }
+        mWake.notify_all();
+    }
+
+    SearchResult ThreadPool::search(const Position &pos, const Limits &limits) {
+        this->wait();
+        this->prepare(limits);
+        return this->run_workers(pos, limits, Worker::Role::kSilent);
+    }
+
+    void ThreadPool::stop() {
+        mStop.store(true, std::memory_order_relaxed);
+        for (auto &state : mPrivate) state->stop.store(true, std::memory_order_relaxed);
+    }
+
+    void ThreadPool::ponderhit() {
+        mPondering.store(false, std::memory_order_relaxed);
+    }
+
+    void ThreadPool::wait() {
+        std::unique_lock lock{mMutex};
+        mDone.wait(lock, [&]() { return !mMainBusy; });
+    }
+
+    void ThreadPool::clear() {
+        for (auto &worker : mWorkers) worker->clear();
+        for (auto &state : mPrivate) state->tt.clear();
+        if (mSolver) mSolver->clear();
+    }
+
+    u64 ThreadPool::nodes() const {
+        u64 total = 0;
+        for (const auto &worker : mWorkers) total += worker->nodes();
+        return total;
+    }
+
+    stats::Counters ThreadPool::stats() const {
+        stats::Counters total;
+        for (const auto &worker : mWorkers) total += worker->stats();
+        return total;
+    }
+
+    void ThreadPool::clear_stats() {
+        for (auto &worker : mWorkers) worker->clear_stats();
+    }
+
+    bool ThreadPool::save_trace(const std::string &prefix) const {
+        for (usize i = 0; i < mWorkers.size(); ++i) {
+            if (!mWorkers[i]->trace().save(prefix + "-" + std::to_string(i) + ".bin")) return false;
+        }
+        return true;
+    }
+
+    void ThreadPool::clear_trace() {
+        for (auto &worker : mWorkers) worker->clear_trace();
+    }
+
+    void ThreadPool::main_search() {
+        const Position &pos = mRootPos;
+        Limits limits = mRootLimits;
+        SearchResult result;
+        bool solved = false;
+
+        if (limits.mate > 0) {
+            TimeManager clock;
+            clock.start(limits, pos.stm());
+            solved = this->solve_mate(pos, limits, result);
+
+            // Without a proof, a normal search gives the GUI a move, as deep as the mate it asked about unless a
+            // depth was given as well, with what the solver left of the budget
+            if (!solved && !mStop.load(std::memory_order_relaxed)) {
+                utils::LineBuffer line;
+                line << "info string no mate in " << limits.mate << " found";
+                line.flush();
+                limits.depth = std::min(limits.depth, 2 * limits.mate);
+
+                const i64 elapsed = clock.elapsed();
+                if (limits.nodes) limits.nodes = std::max<u64>(limits.nodes - std::min(result.nodes, limits.nodes), 1);
+                if (limits.movetime) limits.movetime = std::max<i64>(limits.movetime - elapsed, 1);
+                if (limits.time[pos.stm()]) limits.time[pos.stm()] = std::max<i64>(limits.time[pos.stm()] - elapsed, 1);
+            }
+        }
+
+        if (!solved) result = this->run_workers(pos, limits, Worker::Role::kMain);
+        else this->hold_best_move(limits);
+
+        utils::LineBuffer line;
+        line << "bestmove ";
+        if (result.bestMove != Moves::kNone) put_move(line, result.bestMove, limits.chess960);
+        else line << "0000";
+
+        if (result.pv.size() >= 2) {
+            line << " ponder ";
+            put_move(line, result.pv[1], limits.chess960);
+        }
+        line.flush();
+    }
+
+    SearchResult ThreadPool::run_workers(const Position &pos, const Limits &limits, Worker::Role role) {
+        TimeManager clock;
+        clock.start(limits, pos.stm());
+
+        mJobPos = &pos;
+        mJobLimits = &limits;
+        {
+            std::lock_guard lock{mMutex};
+            mHelpersBusy = mWorkers.size() - 1;
+            ++mHelperJobs;
+        }
+        mWake.notify_all();
+
+        (void)mWorkers[0]->run(pos, mDeterministic ? this->share_limits(limits, 0) : limits, role);
+
+        // Deterministic helpers are left to finish their share of a node or depth limit, but when the clock ended
+        // the main worker's search it ends theirs too. A stop from the GUI reaches them through stop().
+        this->hold_best_move(limits);
+        if (limits.movetime || limits.time[pos.stm()]) {
+            for (auto &state : mPrivate) state->stop.store(true, std::memory_order_relaxed);
+        }
+        {
+            std::unique_lock lock{mMutex};
+            mDone.wait(lock, [&]() { return mHelpersBusy == 0; });
+        }
+
+        if (!mDeterministic) return mWorkers[0]->result();
+
+        usize best = 0;
+        for (usize i = 1; i < mWorkers.size(); ++i) {
+            const SearchResult &candidate = mWorkers[i]->result();
+            const SearchResult &current = mWorkers[best]->result();
+            if (candidate.bestMove != Moves::kNone && (current.bestMove == Moves::kNone || candidate.depth > current.depth)) best = i;
+        }
+
+        SearchResult result = mWorkers[best]->result();
+        result.nodes = this->nodes();
+        if (role == Worker::Role::kMain) report_result(result, clock.elapsed(), limits.chess960);
+        return result;
+    }
+
+    Limits ThreadPool::share_limits(const Limits &limits, usize idx) const {
+        Limits share = limits;
+
+        // Only the main worker watches the clock and the ponder state; the pool stops the helpers for it
+        if (idx > 0) {
+            share.movetime = 0;
+            share.time.fill(0);
+            share.inc.fill(0);
+            share.movestogo = 0;
+            share.infinite = false;
+            share.ponder = false;
+        }
+
+        if (!limits.nodes) return share;
+
+        // The main worker takes what does not divide evenly
+        const u64 helperShare = std::max<u64>(limits.nodes / mWorkers.size(), 1);
+        share.nodes = idx > 0 ? helperShare : std::max<u64>(limits.nodes - helperShare * (mWorkers.size() - 1), 1);
+        return share;
+    }
+
+    void ThreadPool::hold_best_move(const Limits &limits) {
+        while ((limits.infinite || this->pondering()) && !mStop.load(std::memory_order_relaxed))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        mStop.store(true, std::memory_order_relaxed);
+        mPondering.store(false, std::memory_order_relaxed);
+    }
+
+    bool ThreadPool::solve_mate(const Position &pos, const Limits &limits, SearchResult &result) {
+        TimeManager clock;
+        clock.start(limits, pos.stm());
+
+        if (!mSolver) mSolver = std::make_unique<mate::Solver>(mStop, mHashMB);
+
+        Limits budget = limits;
+        if (limits.nodes) budget.nodes = std::max<u64>(limits.nodes / 2, 1);
+        if (limits.movetime) budget.movetime = std::max<i64>(limits.movetime / 2, 1);
+        if (limits.time[pos.stm()]) budget.time[pos.stm()] = std::max<i64>(limits.time[pos.stm()] / 2, 1);
+
+        const mate::Result mate = mSolver->solve(pos, budget);
+        result.nodes = mate.nodes;
+        if (!mate.moves) return false;
+
+        result.bestMove = mate.pv[0];
+        result.score = Scores::kMate - (2 * mate.moves - 1);
+        result.depth = 2 * mate.moves - 1;
+        result.seldepth = result.depth;
+        result.nodes = mate.nodes;
+        result.pv = mate.pv;
+
+        report_result(result, clock.elapsed(), limits.chess960);
+        return true;
+    }
+}
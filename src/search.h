@@ -0,0 +1,347 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "core.h"
+#include "move.h"
+#include "movegen.h"
+#include "movepick.h"
+#include "nnue.h"
+#include "position.h"
+#include "stats.h"
+#include "trace.h"
+#include "tt.h"
+#include "types.h"
+#include "utils/arena.h"
+#include "utils/arrayvec.h"
+#include "utils/mdarray.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace purebred::mate {
+    class Solver;
+}
+
+namespace purebred::search {
+
+    constexpr i32 kMaxDepth = 128;
+    constexpr usize kMaxThreads = 1024;
+
+    using PVLine = utils::ArrayVec<Move, kMaxPly>;
+
+    struct Limits {
+        i32 depth = kMaxDepth;
+        u64 nodes = 0;
+        i64 movetime = 0;
+        utils::MDArray<i64, Colour::kNumTypes> time = {0, 0};
+        utils::MDArray<i64, Colour::kNumTypes> inc = {0, 0};
+        i32 movestogo = 0;
+        bool infinite = false;
+        usize multiPV = 1;
+
+        // Look for a forced mate in at most this many moves with the mate solver before searching normally
+        i32 mate = 0;
+
+        // Search the position expected after our predicted reply without a time limit, until the GUI sends
+        // ponderhit (from which point the time limits apply) or stop
+        bool ponder = false;
+
+        // Only affects output: castling is printed as king-takes-rook
+        bool chess960 = false;
+    };
+
+    // Bookkeeping for each legal move at the root. Scores are only exact for moves which raised alpha;
+    // the rest are left at -kInf, which keeps them below every searched line when sorting.
+    struct RootMove {
+        Move move = Moves::kNone;
+        Score score = -Scores::kInf;
+        Score previousScore = -Scores::kInf;
+        i32 seldepth = 0;
+        u64 nodes = 0;
+        PVLine pv;
+
+        [[nodiscard]] bool operator==(const RootMove &) const = default;
+    };
+
+    using RootMoves = utils::ArrayVec<RootMove, kMaxMoves>;
+
+    struct SearchResult {
+        Move bestMove = Moves::kNone;
+        Score score = Scores::kNone;
+        i32 depth = 0;
+        i32 seldepth = 0;
+        u64 nodes = 0;
+        PVLine pv;
+    };
+
+    class TimeManager {
+    public:
+        void start(const Limits &limits, Colour stm);
+
+        [[nodiscard]] i64 elapsed() const {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mStart).count();
+        }
+
+        // Moves the start of the clock to now, keeping the allocated time
+        void restart() {
+            mStart = std::chrono::steady_clock::now();
+        }
+
+        // The soft limit is checked between iterations, the hard limit while searching.
+        [[nodiscard]] bool soft_expired() const {
+            return mTimed && this->elapsed() >= mSoft;
+        }
+
+        [[nodiscard]] bool hard_expired() const {
+            return mTimed && this->elapsed() >= mHard;
+        }
+
+    private:
+        std::chrono::steady_clock::time_point mStart;
+        i64 mSoft = 0;
+        i64 mHard = 0;
+        bool mTimed = false;
+    };
+
+    struct StackEntry {
+        PVLine pv;
+        Move move;
+        Move killer;
+        Score staticEval;
+
+        // Set while verifying whether the TT move is singular; the node is then searched without it
+        Move excluded;
+
+        [[nodiscard]] bool operator==(const StackEntry &) const = default;
+    };
+
+    using SearchStack = utils::MDArray<StackEntry, kMaxPly + 1>;
+
+    class ThreadPool;
+
+    class Worker {
+    public:
+        // The main worker enforces the limits and reports progress, helpers only search until told to stop,
+        // and silent workers enforce their own limits without printing anything.
+        enum class Role {
+            kMain,
+            kHelper,
+            kSilent
+        };
+
+        // A stagger index other than 0 makes the worker skip some depths of iterative deepening, following a
+        // fixed pattern per index, so that workers searching on their own do not all search the same trees
+        Worker(TranspositionTable &tt, std::atomic<bool> &stop, ThreadPool *pool = nullptr, usize stagger = 0)
+            : mTT(tt), mStop(stop), mPool(pool), mStagger(stagger) {}
+
+        // The result stays valid until the next search
+        const SearchResult &run(const Position &pos, const Limits &limits, Role role);
+
+        void clear();
+
+        [[nodiscard]] u64 nodes() const {
+            return mNodes.load(std::memory_order_relaxed);
+        }
+
+        // The result of the last search. Only meaningful while the worker is idle.
+        [[nodiscard]] const SearchResult &result() const {
+            return mResult;
+        }
+
+        // Only meaningful while the worker is idle
+        [[nodiscard]] const stats::Counters &stats() const {
+            return mStats;
+        }
+
+        void clear_stats() {
+            mStats.clear();
+        }
+
+        [[nodiscard]] const trace::Buffer &trace() const {
+            return mTrace;
+        }
+
+        void clear_trace() {
+            mTrace.clear();
+        }
+
+    private:
+        TranspositionTable &mTT;
+        std::atomic<bool> &mStop;
+        ThreadPool *mPool;
+        usize mStagger;
+
+        Position mPos;
+        Limits mLimits;
+        TimeManager mTime;
+        Role mRole = Role::kMain;
+
+        std::atomic<u64> mNodes = 0;
+        i32 mSeldepth = 0;
+        SearchResult mResult;
+
+        // Whether the time limits are suspended because we are pondering; only ever set for the main worker
+        bool mPondering = false;
+
+        // The per-ply and per-thread tables share one block, allocated when the worker is created, so nothing
+        // is allocated while searching and each thread's working set stays contiguous
+        utils::Arena mArena{utils::Arena::footprint<SearchStack, ButterflyHistory, nnue::AccumulatorStack, RootMoves>()};
+        SearchStack &mStack = mArena.make<SearchStack>();
+        ButterflyHistory &mHistory = mArena.make<ButterflyHistory>();
+        nnue::AccumulatorStack &mAccumulators = mArena.make<nnue::AccumulatorStack>();
+
+        // Root moves before mPVIdx already have their MultiPV line for this iteration and are skipped
+        RootMoves &mRootMoves = mArena.make<RootMoves>();
+        usize mPVIdx = 0;
+        stats::Counters mStats;
+        trace::Buffer mTrace;
+
+        template <bool kPV>
+        Score negamax(i32 depth, Score alpha, Score beta, i32 ply, bool cutnode);
+
+        template <bool kPV>
+        Score qsearch(Score alpha, Score beta, i32 ply);
+
+        [[nodiscard]] Score evaluate();
+        [[nodiscard]] bool should_stop();
+        [[nodiscard]] bool skips_depth(i32 depth) const;
+        void check_ponderhit();
+        void update_history(Move move, i32 bonus);
+        void decay_history();
+        void order_root_moves();
+        void report(i32 depth, usize multiPV) const;
+        void report_currmove(i32 depth, Move move, usize number) const;
+    };
+
+    // Runs a Lazy SMP search for UCI: every worker searches the same root and communicates through the shared TT.
+    // Each worker has a thread of its own, created along with it and parked between searches, so starting a
+    // search only wakes threads up.
+    //
+    // In deterministic mode, results depend only on the position, the limits and the thread count, never on how
+    // the threads are scheduled. Helpers then search on their own, each with a private table, a fixed pattern of
+    // skipped depths and its share of the node limit, and the deepest result wins (the main worker's on ties).
+    // The private tables split the Hash size between every thread, on top of the shared table.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(TranspositionTable &tt);
+        ~ThreadPool();
+
+        void set_threads(usize count);
+        void set_deterministic(bool deterministic);
+
+        // Resizes the shared table and, in deterministic mode, the helpers' private ones
+        void set_hash(usize megabytes);
+        void start(const Position &pos, const Limits &limits);
+
+        // Searches on the calling thread without printing anything, for benchmarks
+        [[nodiscard]] SearchResult search(const Position &pos, const Limits &limits);
+
+        void stop();
+        void wait();
+        void clear();
+
+        // Turns a ponder search into a normal timed search without interrupting it
+        void ponderhit();
+
+        [[nodiscard]] bool pondering() const {
+            return mPondering.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] u64 nodes() const;
+
+        // Statistics summed over every worker, accumulated since the last clear_stats()
+        [[nodiscard]] stats::Counters stats() const;
+        void clear_stats();
+
+        // Writes each worker's trace buffer to <prefix>-<index>.bin
+        [[nodiscard]] bool save_trace(const std::string &prefix) const;
+        void clear_trace();
+
+    private:
+        // What each helper has to itself in deterministic mode
+        struct PrivateState {
+            explicit PrivateState(usize megabytes) : tt(megabytes) {}
+
+            TranspositionTable tt;
+            std::atomic<bool> stop = false;
+        };
+
+        TranspositionTable &mTT;
+        std::atomic<bool> mStop = false;
+        std::atomic<bool> mPondering = false;
+        std::vector<std::unique_ptr<Worker>> mWorkers;
+
+        // mThreads[0] runs the searches started by start(), the rest run mWorkers[1..] for run_workers(). The
+        // counters are bumped to hand out work; everything from here to mHelpersBusy is guarded by mMutex.
+        std::vector<std::thread> mThreads;
+        std::mutex mMutex;
+        std::condition_variable mWake;
+        std::condition_variable mDone;
+        u64 mMainJobs = 0;
+        u64 mHelperJobs = 0;
+        bool mMainBusy = false;
+        usize mHelpersBusy = 0;
+        bool mQuit = false;
+
+        // What the threads are to search: the copy made by start(), and the arguments of run_workers()
+        Position mRootPos;
+        Limits mRootLimits;
+        const Position *mJobPos = nullptr;
+        const Limits *mJobLimits = nullptr;
+
+        usize mHashMB = TranspositionTable::kDefaultSizeMB;
+        bool mDeterministic = false;
+        std::vector<std::unique_ptr<PrivateState>> mPrivate;
+
+        // Allocated by the first `go mate`, as large as the hash table, and kept until Hash changes
+        std::unique_ptr<mate::Solver> mSolver;
+
+        [[nodiscard]] usize private_hash(usize threads) const {
+            return std::max<usize>(mHashMB / threads, 1);
+        }
+
+        void prepare(const Limits &limits);
+        void thread_loop(usize idx);
+        void join_threads();
+        void main_search();
+
+        // Runs every worker, waits for all of them to finish and returns the result to play
+        [[nodiscard]] SearchResult run_workers(const Position &pos, const Limits &limits, Worker::Role role);
+
+        // Worker `idx`'s part of a deterministic search: its share of the node limit, and for helpers no clock
+        [[nodiscard]] Limits share_limits(const Limits &limits, usize idx) const;
+
+        // In infinite mode or while pondering, the best move may only be sent after the GUI tells us to stop
+        // (or, when pondering, that the expected move was played)
+        void hold_best_move(const Limits &limits);
+
+        // Runs the mate solver for `go mate` on half of the node and time budget, reporting and filling in the
+        // result if it proves a mate. The result's node count is set either way.
+        [[nodiscard]] bool solve_mate(const Position &pos, const Limits &limits, SearchResult &result);
+    };
+}
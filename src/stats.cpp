@@ -0,0 +1,80 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "stats.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace purebred::stats {
+
+    namespace {
+        void print_ratio(std::ostream &out, const char *name, u64 part, u64 whole) {
+            out << "  " << std::left << std::setw(22) << name << std::right << std::setw(14) << part << " / " << std::setw(14) << whole;
+            if (whole) out << "  (" << std::fixed << std::setprecision(2) << 100.0 * static_cast<f64>(part) / static_cast<f64>(whole) << "%)";
+            out << "\n";
+        }
+
+        void print_count(std::ostream &out, const char *name, u64 count) {
+            out << "  " << std::left << std::setw(22) << name << std::right << std::setw(14) << count << "\n";
+        }
+    }
+
+    Counters &Counters::operator+=(const Counters &other) {
+        for (usize i = 0; i < mCounters.size(); ++i) mCounters[i] += other.mCounters[i];
+        for (usize i = 0; i < mSources.size(); ++i) mSources[i] += other.mSources[i];
+        for (usize i = 0; i < mCutoffIndices.size(); ++i) mCutoffIndices[i] += other.mCutoffIndices[i];
+        return *this;
+    }
+
+    void Counters::print(std::ostream &out) const {
+        if constexpr (!kEnabled) {
+            out << "Statistics are not available; rebuild with `make STATS=yes`" << std::endl;
+            return;
+        }
+
+        const u64 nodes = this->get(Counter::kNodes) + this->get(Counter::kQNodes);
+        const u64 cutoffs = this->get(Counter::kBetaCutoffs);
+
+        out << "Search statistics\n";
+        print_ratio(out, "qsearch nodes", this->get(Counter::kQNodes), nodes);
+        print_ratio(out, "evaluations", this->get(Counter::kEvals), nodes);
+        print_ratio(out, "tt hits", this->get(Counter::kTTHits), this->get(Counter::kTTProbes));
+        print_ratio(out, "tt cutoffs", this->get(Counter::kTTCutoffs), this->get(Counter::kTTProbes));
+        print_ratio(out, "rfp prunes", this->get(Counter::kRfpPrunes), this->get(Counter::kRfpAttempts));
+        print_ratio(out, "nmp cutoffs", this->get(Counter::kNmpCutoffs), this->get(Counter::kNmpAttempts));
+        print_ratio(out, "lmr re-searches", this->get(Counter::kLmrResearches), this->get(Counter::kLmrSearches));
+        print_ratio(out, "singular extensions", this->get(Counter::kSingularExtensions), this->get(Counter::kSingularSearches));
+        print_ratio(out, "multi-cuts", this->get(Counter::kMultiCuts), this->get(Counter::kSingularSearches));
+        print_count(out, "futility pruned moves", this->get(Counter::kFutilityPrunes));
+        print_count(out, "lmp pruned moves", this->get(Counter::kLmpPrunes));
+        print_ratio(out, "nnue refreshes", this->get(Counter::kNnueRefreshes),
+                    this->get(Counter::kNnueRefreshes) + this->get(Counter::kNnueUpdates));
+
+        out << "Main search beta cutoffs by move index\n";
+        constexpr utils::MDArray<const char *, kCutoffBuckets> kBucketNames = {"1", "2", "3", "4", "5-8", "9-16", "17+"};
+        for (usize i = 0; i < kCutoffBuckets; ++i) print_ratio(out, kBucketNames[i], mCutoffIndices[i], cutoffs);
+
+        out << "Main search beta cutoffs by move source\n";
+        constexpr utils::MDArray<const char *, static_cast<usize>(Source::kNum)> kSourceNames = {"tt move", "noisy", "killer", "quiet"};
+        for (usize i = 0; i < mSources.size(); ++i) print_ratio(out, kSourceNames[i], mSources[i], cutoffs);
+
+        out << std::flush;
+    }
+}
@@ -0,0 +1,113 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "types.h"
+#include "utils/mdarray.h"
+
+#include <iosfwd>
+
+// Search instrumentation. Counters are only recorded in builds made with `make STATS=yes`;
+// otherwise every recording call compiles to nothing.
+namespace purebred::stats {
+
+#ifdef USE_STATS
+    constexpr bool kEnabled = true;
+#else
+    constexpr bool kEnabled = false;
+#endif
+
+    enum class Counter : usize {
+        kNodes,
+        kQNodes,
+        kEvals,
+        kTTProbes,
+        kTTHits,
+        kTTCutoffs,
+        kRfpAttempts,
+        kRfpPrunes,
+        kNmpAttempts,
+        kNmpCutoffs,
+        kFutilityPrunes,
+        kLmpPrunes,
+        kLmrSearches,
+        kLmrResearches,
+        kSingularSearches,
+        kSingularExtensions,
+        kMultiCuts,
+        kBetaCutoffs,
+        kNnueRefreshes,
+        kNnueUpdates,
+        kNum
+    };
+
+    // Which part of the move ordering produced a beta cutoff
+    enum class Source : usize {
+        kTTMove,
+        kNoisy,
+        kKiller,
+        kQuiet,
+        kNum
+    };
+
+    // Cutoffs are bucketed by the (1-based) index of the move which caused them: 1, 2, 3, 4, 5-8, 9-16, 17+
+    constexpr usize kCutoffBuckets = 7;
+
+    class Counters {
+    public:
+        void inc(Counter counter) {
+            if constexpr (kEnabled) mCounters[static_cast<usize>(counter)]++;
+        }
+
+        void cutoff(i32 moveIndex, Source source) {
+            if constexpr (kEnabled) {
+                mCounters[static_cast<usize>(Counter::kBetaCutoffs)]++;
+                mSources[static_cast<usize>(source)]++;
+                mCutoffIndices[bucket(moveIndex)]++;
+            }
+        }
+
+        void clear() {
+            mCounters.fill(0);
+            mSources.fill(0);
+            mCutoffIndices.fill(0);
+        }
+
+        Counters &operator+=(const Counters &other);
+
+        void print(std::ostream &out) const;
+
+    private:
+        utils::MDArray<u64, static_cast<usize>(Counter::kNum)> mCounters{};
+        utils::MDArray<u64, static_cast<usize>(Source::kNum)> mSources{};
+        utils::MDArray<u64, kCutoffBuckets> mCutoffIndices{};
+
+        [[nodiscard]] static usize bucket(i32 moveIndex) {
+            if (moveIndex <= 4) return static_cast<usize>(moveIndex - 1);
+            if (moveIndex <= 8) return 4;
+            if (moveIndex <= 16) return 5;
+            return 6;
+        }
+
+        [[nodiscard]] u64 get(Counter counter) const {
+            return mCounters[static_cast<usize>(counter)];
+        }
+    };
+}
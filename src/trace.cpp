@@ -0,0 +1,170 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "trace.h"
+
+#include "utils/mapped_file.h"
+#include "utils/mdarray.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace purebred::trace {
+
+    namespace {
+        constexpr utils::MDArray<char, 8> kMagic = {'P', 'B', 'T', 'R', 'A', 'C', 'E', '1'};
+
+        struct Header {
+            utils::MDArray<char, 8> magic;
+            u64 total;   // events recorded, including those overwritten in the ring buffer
+            u64 count;   // records that follow the header
+        };
+
+        constexpr utils::MDArray<const char *, static_cast<usize>(Event::kNum)> kEventNames = {
+            "nodes", "moves searched", "draws", "tt cutoffs", "rfp prunes", "nmp cutoffs", "lmp pruned moves", "futility pruned moves"
+        };
+
+        struct Summary {
+            u64 total = 0;
+            u64 records = 0;
+            utils::MDArray<u64, static_cast<usize>(Event::kNum)> events{};
+            std::map<i32, u64> nodesByDepth;
+            std::map<i32, u64> reductions;
+            u64 reduced = 0;
+            u64 reducedResearches = 0;
+            u64 nullWindow = 0;
+            u64 pvResearches = 0;
+            u64 failHighs = 0;
+            u64 alphaRaises = 0;
+
+            void add(const Record &record) {
+                records++;
+                if (record.event >= Event::kNum) return;
+                events[static_cast<usize>(record.event)]++;
+
+                if (record.event == Event::kNode) nodesByDepth[record.depth]++;
+                if (record.event != Event::kMove) return;
+
+                if (record.score >= record.beta) failHighs++;
+                else if (record.score > record.alpha) alphaRaises++;
+
+                // The first move of a node is always searched with the full window and depth
+                if (record.moveIndex <= 1) return;
+                nullWindow++;
+                reductions[record.reduction]++;
+                if (record.reduction > 0) reduced++;
+                if (record.flags & kReducedResearch) reducedResearches++;
+                if (record.flags & kPVResearch) pvResearches++;
+            }
+        };
+
+        void print_ratio(const char *name, u64 part, u64 whole) {
+            std::cout << "  " << std::left << std::setw(22) << name << std::right << std::setw(14) << part << " / " << std::setw(14) << whole;
+            if (whole) std::cout << "  (" << std::fixed << std::setprecision(2) << 100.0 * static_cast<f64>(part) / static_cast<f64>(whole) << "%)";
+            std::cout << "\n";
+        }
+
+        [[nodiscard]] bool read_file(const std::string &path, Summary &summary) {
+            utils::MappedFile file;
+            if (!file.open(path)) {
+                std::cerr << "Could not map " << path << std::endl;
+                return false;
+            }
+
+            Header header;
+            if (file.size() < sizeof(Header)) {
+                std::cerr << path << " is not a trace file" << std::endl;
+                return false;
+            }
+            std::memcpy(&header, file.data(), sizeof(Header));
+
+            if (header.magic != kMagic || file.size() != sizeof(Header) + header.count * sizeof(Record)) {
+                std::cerr << path << " is not a trace file" << std::endl;
+                return false;
+            }
+
+            summary.total += header.total;
+            for (u64 i = 0; i < header.count; ++i) {
+                Record record;
+                std::memcpy(&record, file.data() + sizeof(Header) + i * sizeof(Record), sizeof(Record));
+                summary.add(record);
+            }
+
+            return true;
+        }
+    }
+
+    bool Buffer::save(const std::string &path) const {
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+
+        const u64 count = std::min<u64>(mTotal, mRecords.size());
+        const Header header{kMagic, mTotal, count};
+        bool ok = std::fwrite(&header, sizeof(Header), 1, file) == 1;
+
+        // Once the buffer has wrapped, the oldest record is the one which will be overwritten next
+        const usize begin = mTotal > count ? static_cast<usize>(mTotal & (kCapacity - 1)) : 0;
+        for (u64 i = 0; ok && i < count; ++i)
+            ok = std::fwrite(&mRecords[(begin + i) & (kCapacity - 1)], sizeof(Record), 1, file) == 1;
+
+        return std::fclose(file) == 0 && ok;
+    }
+
+    i32 run(i32 argc, char *argv[]) {
+        if (argc < 3) {
+            std::cerr << "Usage: " << argv[0] << " trace <file> [<file> ...]" << std::endl;
+            return 1;
+        }
+
+        Summary summary;
+        for (i32 i = 2; i < argc; ++i) {
+            if (!read_file(argv[i], summary)) return 1;
+        }
+
+        std::cout << "Trace summary: " << summary.records << " records";
+        if (summary.total > summary.records) std::cout << " (" << summary.total - summary.records << " older events were overwritten)";
+        std::cout << "\n";
+
+        std::cout << "Events\n";
+        for (usize i = 0; i < kEventNames.size(); ++i) print_ratio(kEventNames[i], summary.events[i], summary.records);
+
+        const u64 nodes = summary.events[static_cast<usize>(Event::kNode)];
+        std::cout << "Nodes by depth\n";
+        for (const auto &[depth, count] : summary.nodesByDepth)
+            print_ratio(std::to_string(depth).c_str(), count, nodes);
+
+        std::cout << "Reductions of later moves\n";
+        for (const auto &[reduction, count] : summary.reductions)
+            print_ratio(std::to_string(reduction).c_str(), count, summary.nullWindow);
+
+        const u64 moves = summary.events[static_cast<usize>(Event::kMove)];
+        std::cout << "Re-searches\n";
+        print_ratio("after reduction", summary.reducedResearches, summary.reduced);
+        print_ratio("with full window", summary.pvResearches, summary.nullWindow);
+        std::cout << "Move results\n";
+        print_ratio("fail high", summary.failHighs, moves);
+        print_ratio("raised alpha", summary.alphaRaises, moves);
+
+        std::cout << std::flush;
+        return 0;
+    }
+}
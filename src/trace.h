@@ -0,0 +1,123 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "core.h"
+#include "move.h"
+#include "types.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Search tree tracing for offline analysis. Only recorded in builds made with `make TRACE=yes`;
+// otherwise every recording call compiles to nothing and no buffer is allocated.
+// Each worker keeps the most recent kCapacity events in a ring buffer, which can be saved with the UCI
+// command `trace save <prefix>` and summarised with `Purebred trace <file>...`.
+namespace purebred::trace {
+
+#ifdef USE_TRACE
+    constexpr bool kEnabled = true;
+#else
+    constexpr bool kEnabled = false;
+#endif
+
+    enum class Event : u8 {
+        kNode,        // entered the main search
+        kMove,        // a move was searched and returned a score
+        kDraw,        // the node was scored as a draw without searching
+        kTTCutoff,
+        kRfp,
+        kNmp,
+        kLmp,         // the move was skipped by late move pruning
+        kFutility,    // the move was skipped by futility pruning
+        kNum
+    };
+
+    // Flags of a kMove record
+    constexpr u8 kReducedResearch = 1 << 0;
+    constexpr u8 kPVResearch = 1 << 1;
+
+    struct Record {
+        u64 key;
+        i16 alpha;
+        i16 beta;
+        i16 score;
+        u16 move;
+        i8 depth;
+        u8 ply;
+        u8 reduction;
+        u8 moveIndex;
+        Event event;
+        u8 flags;
+        u16 reserved;
+    };
+
+    static_assert(sizeof(Record) == 24);
+
+    constexpr usize kCapacity = 1 << 20;
+
+    class Buffer {
+    public:
+        Buffer() {
+            if constexpr (kEnabled) mRecords.resize(kCapacity);
+        }
+
+        void node(Event event, u64 key, i32 depth, i32 ply, Score alpha, Score beta, Score score = 0) {
+            if constexpr (kEnabled) this->push(event, key, depth, ply, alpha, beta, score, Moves::kNone, 0, 0, 0);
+        }
+
+        void move(Event event, u64 key, i32 depth, i32 ply, Score alpha, Score beta, Move move, i32 moveIndex,
+                  i32 reduction = 0, u8 flags = 0, Score score = 0) {
+            if constexpr (kEnabled) this->push(event, key, depth, ply, alpha, beta, score, move, moveIndex, reduction, flags);
+        }
+
+        void clear() {
+            mTotal = 0;
+        }
+
+        // Writes the buffered records, oldest first. Returns false if the file could not be written.
+        [[nodiscard]] bool save(const std::string &path) const;
+
+    private:
+        std::vector<Record> mRecords;
+        u64 mTotal = 0;
+
+        void push(Event event, u64 key, i32 depth, i32 ply, Score alpha, Score beta, Score score, Move move,
+                  i32 moveIndex, i32 reduction, u8 flags) {
+            Record &record = mRecords[mTotal++ & (kCapacity - 1)];
+            record.key = key;
+            record.alpha = static_cast<i16>(alpha);
+            record.beta = static_cast<i16>(beta);
+            record.score = static_cast<i16>(score);
+            record.move = move.raw();
+            record.depth = static_cast<i8>(std::clamp(depth, -128, 127));
+            record.ply = static_cast<u8>(ply);
+            record.reduction = static_cast<u8>(reduction);
+            record.moveIndex = static_cast<u8>(std::min(moveIndex, 255));
+            record.event = event;
+            record.flags = flags;
+            record.reserved = 0;
+        }
+    };
+
+    // Aggregates saved trace files. Returns the process exit code.
+    [[nodiscard]] i32 run(i32 argc, char *argv[]);
+}
@@ -0,0 +1,102 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tt.h"
+
+#include <algorithm>
+
+namespace purebred {
+
+    void TranspositionTable::resize(usize megabytes) {
+        const usize clusters = std::max<usize>(megabytes * 1024 * 1024 / sizeof(TTCluster), 1);
+
+        // Release the old table first, so that we never hold two tables at once
+        std::vector<TTCluster>().swap(mClusters);
+        mClusters.resize(clusters);
+        this->clear();
+    }
+
+    void TranspositionTable::clear() {
+        TTCluster empty{};
+        empty.entries.fill(TTEntry{0, Moves::kNone, 0, 0, 0, static_cast<u8>(Bound::kNone)});
+        std::fill(mClusters.begin(), mClusters.end(), empty);
+        mGeneration = 0;
+    }
+
+    bool TranspositionTable::probe(u64 key, TTEntry &entry) const {
+        const u16 key16 = static_cast<u16>(key);
+        for (const TTEntry &candidate : mClusters[this->index(key)].entries) {
+            if (candidate.key == key16 && candidate.bound() != Bound::kNone) {
+                entry = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TranspositionTable::store(u64 key, Move move, Score score, Score staticEval, i32 depth, Bound bound) {
+        TTCluster &cluster = mClusters[this->index(key)];
+        const u16 key16 = static_cast<u16>(key);
+
+        // Overwrite the entry for this position if there is one. Otherwise replace the least valuable entry,
+        // where each search that has passed since an entry was written costs it as much as a few plies of depth.
+        TTEntry *replace = nullptr;
+        for (TTEntry &candidate : cluster.entries) {
+            if (candidate.key == key16 && candidate.bound() != Bound::kNone) {
+                replace = &candidate;
+                break;
+            }
+        }
+
+        if (!replace) {
+            const auto worth = [this](const TTEntry &entry) {
+                return entry.bound() == Bound::kNone ? -1024 : entry.depth - 4 * this->age(entry);
+            };
+
+            replace = &cluster.entries[0];
+            for (TTEntry &candidate : cluster.entries) {
+                if (worth(candidate) < worth(*replace)) replace = &candidate;
+            }
+        }
+
+        TTEntry &entry = *replace;
+
+        // Keep the existing move if we have nothing better to offer for the same position
+        if (move != Moves::kNone || entry.key != key16) entry.move = move;
+
+        // Prefer keeping deeper entries of the same position from this search, unless we now have an exact score
+        if (bound != Bound::kExact && entry.key == key16 && entry.generation() == mGeneration && depth + 4 < entry.depth) return;
+
+        entry.key = key16;
+        entry.score = static_cast<i16>(score);
+        entry.staticEval = static_cast<i16>(staticEval);
+        entry.depth = static_cast<u8>(depth);
+        entry.genBound = static_cast<u8>(mGeneration | static_cast<u8>(bound));
+    }
+
+    i32 TranspositionTable::hashfull() const {
+        const usize sample = std::min<usize>(mClusters.size(), 1000);
+        i32 used = 0;
+        for (usize i = 0; i < sample; ++i) {
+            for (const TTEntry &entry : mClusters[i].entries)
+                used += entry.bound() != Bound::kNone && entry.generation() == mGeneration;
+        }
+        return used * 1000 / static_cast<i32>(sample * TTCluster::kSize);
+    }
+}
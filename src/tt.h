@@ -0,0 +1,128 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "core.h"
+#include "move.h"
+#include "types.h"
+#include "utils/mdarray.h"
+
+#include <vector>
+
+namespace purebred {
+
+    enum class Bound : u8 {
+        kNone,
+        kUpper,
+        kLower,
+        kExact
+    };
+
+    struct TTEntry {
+        // The bound lives in the low bits of genBound, and the generation of the search which wrote the entry
+        // in the remaining ones, so generations advance in steps of kGenerationStep and wrap around naturally.
+        static constexpr u8 kBoundMask = 0b11;
+        static constexpr u8 kGenerationStep = kBoundMask + 1;
+
+        u16 key;
+        Move move;
+        i16 score;
+        i16 staticEval;
+        u8 depth;
+        u8 genBound;
+
+        [[nodiscard]] constexpr Bound bound() const {
+            return static_cast<Bound>(genBound & kBoundMask);
+        }
+
+        [[nodiscard]] constexpr u8 generation() const {
+            return genBound & ~kBoundMask;
+        }
+
+        [[nodiscard]] constexpr bool operator==(const TTEntry &) const = default;
+    };
+
+    static_assert(sizeof(TTEntry) == 10);
+
+    // Entries which share an index, sized so that a cluster fills half a cache line
+    struct TTCluster {
+        static constexpr usize kSize = 3;
+
+        utils::MDArray<TTEntry, kSize> entries;
+        u16 padding;
+    };
+
+    static_assert(sizeof(TTCluster) == 32);
+
+    class TranspositionTable {
+    public:
+        static constexpr usize kDefaultSizeMB = 16;
+
+        explicit TranspositionTable(usize megabytes = kDefaultSizeMB) {
+            this->resize(megabytes);
+        }
+
+        void resize(usize megabytes);
+        void clear();
+
+        // Called once per search, so that entries left over from earlier searches are replaced first
+        void new_search() {
+            mGeneration += TTEntry::kGenerationStep;
+        }
+
+        // Copies the entry for this key into `entry` and returns true on a hit.
+        [[nodiscard]] bool probe(u64 key, TTEntry &entry) const;
+        void store(u64 key, Move move, Score score, Score staticEval, i32 depth, Bound bound);
+
+        void prefetch(u64 key) const {
+            __builtin_prefetch(&mClusters[this->index(key)]);
+        }
+
+        // Permille of entries written by the current search, sampled from the start of the table
+        [[nodiscard]] i32 hashfull() const;
+
+    private:
+        std::vector<TTCluster> mClusters;
+        u8 mGeneration = 0;
+
+        [[nodiscard]] usize index(u64 key) const {
+            return static_cast<usize>((static_cast<u128>(key) * mClusters.size()) >> 64);
+        }
+
+        // Number of searches since the entry was written
+        [[nodiscard]] i32 age(const TTEntry &entry) const {
+            return static_cast<u8>(mGeneration - entry.generation()) / TTEntry::kGenerationStep;
+        }
+    };
+
+    // Mate scores are stored relative to the current node rather than the root, so that they stay valid
+    // when the same position is reached at a different ply.
+    [[nodiscard]] constexpr Score score_to_tt(Score score, i32 ply) {
+        if (score >= Scores::kMateInMaxPly) return score + ply;
+        if (score <= -Scores::kMateInMaxPly) return score - ply;
+        return score;
+    }
+
+    [[nodiscard]] constexpr Score score_from_tt(Score score, i32 ply) {
+        if (score >= Scores::kMateInMaxPly) return score - ply;
+        if (score <= -Scores::kMateInMaxPly) return score + ply;
+        return score;
+    }
+}
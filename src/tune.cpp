@@ -0,0 +1,66 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tune.h"
+
+#include "utils/parse.h"
+
+#include <iostream>
+
+namespace purebred::tune {
+
+    Param::Param(const char *paramName, i32 defaultValue, i32 minValue, i32 maxValue, i32 stepValue)
+        : name(paramName), value(defaultValue), min(minValue), max(maxValue), step(stepValue) {
+        params().push_back(this);
+    }
+
+    std::vector<Param *> &params() {
+        // A function-local static, so that parameters can register themselves during static initialisation
+        static std::vector<Param *> registry;
+        return registry;
+    }
+
+    SetResult set(const std::string &name, const std::string &value) {
+        for (Param *param : params()) {
+            if (name != param->name) continue;
+
+            const auto parsed = utils::parse_int<i32>(value);
+            if (!parsed || *parsed < param->min || *parsed > param->max) return SetResult::kInvalidValue;
+            param->value = *parsed;
+            return SetResult::kOk;
+        }
+
+        return SetResult::kUnknownName;
+    }
+
+    void print_uci_options(std::ostream &out) {
+        for (const Param *param : params()) {
+            out << "option name " << param->name << " type spin default " << param->value
+                << " min " << param->min << " max " << param->max << "\n";
+        }
+    }
+
+    void print_spsa(std::ostream &out) {
+        for (const Param *param : params()) {
+            out << param->name << ", int, " << param->value << ", " << param->min << ", " << param->max
+                << ", " << param->step << ", 0.002\n";
+        }
+        out << std::flush;
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "types.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Registry of tunable search parameters. In builds made with `make TUNE=yes`, every parameter declared with
+// TUNABLE is a runtime value exposed as a UCI spin option; otherwise each one is a constexpr function returning
+// its default, so release builds fold them exactly like literal constants.
+namespace purebred::tune {
+
+#ifdef USE_TUNE
+    constexpr bool kEnabled = true;
+#else
+    constexpr bool kEnabled = false;
+#endif
+
+    struct Param {
+        const char *name;
+        i32 value;
+        i32 min;
+        i32 max;
+        i32 step;   // SPSA perturbation size at the end of tuning (c_end)
+
+        Param(const char *paramName, i32 defaultValue, i32 minValue, i32 maxValue, i32 stepValue);
+    };
+
+    // Every registered parameter, in registration order. Empty unless tuning is enabled.
+    [[nodiscard]] std::vector<Param *> &params();
+
+    enum class SetResult {
+        kOk,
+        kUnknownName,
+        kInvalidValue
+    };
+
+    // Sets the parameter with this name. The value must be an integer within the parameter's range, otherwise
+    // the parameter is left unchanged.
+    [[nodiscard]] SetResult set(const std::string &name, const std::string &value);
+
+    void print_uci_options(std::ostream &out);
+
+    // One line per parameter in the OpenBench SPSA input format: name, int, value, min, max, c_end, r_end
+    void print_spsa(std::ostream &out);
+}
+
+#ifdef USE_TUNE
+    #define TUNABLE(name, defaultValue, minValue, maxValue, step)                                 \
+        inline purebred::tune::Param name##Param{#name, defaultValue, minValue, maxValue, step}; \
+        [[nodiscard]] inline i32 name() {                                                      \
+            return name##Param.value;                                                          \
+        }
+#else
+    #define TUNABLE(name, defaultValue, minValue, maxValue, step)                                 \
+        [[nodiscard]] constexpr i32 name() {                                                   \
+            return defaultValue;                                                               \
+        }
+#endif
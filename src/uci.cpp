@@ -0,0 +1,272 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "uci.h"
+
+#include "bench.h"
+#include "core.h"
+#include "eval.h"
+#include "nnue.h"
+#include "perft.h"
+#include "position.h"
+#include "search.h"
+#include "tt.h"
+#include "tune.h"
+#include "utils/parse.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace purebred::uci {
+
+    namespace {
+        constexpr usize kMaxHashMB = 65536;
+        constexpr usize kMaxMultiPV = kMaxMoves;
+
+        struct Engine {
+            TranspositionTable tt;
+            search::ThreadPool pool{tt};
+            Position pos = Position::startpos();
+            usize multiPV = 1;
+            bool chess960 = false;
+
+            // The arguments of the last `position` command, if it succeeded
+            std::string lastPosition;
+        };
+
+        void handle_uci() {
+            std::cout << "id name " << kName << "\n";
+            std::cout << "id author " << kAuthor << "\n";
+            std::cout << "option name Hash type spin default " << TranspositionTable::kDefaultSizeMB << " min 1 max " << kMaxHashMB << "\n";
+            std::cout << "option name Threads type spin default 1 min 1 max " << search::kMaxThreads << "\n";
+            std::cout << "option name MultiPV type spin default 1 min 1 max " << kMaxMultiPV << "\n";
+            std::cout << "option name Ponder type check default false\n";
+            std::cout << "option name UCI_Chess960 type check default false\n";
+            std::cout << "option name Deterministic type check default false\n";
+            std::cout << "option name EvalFile type string default <empty>\n";
+            tune::print_uci_options(std::cout);
+            std::cout << "uciok" << std::endl;
+        }
+
+        void handle_setoption(Engine &engine, std::istringstream &stream) {
+            std::string token, name, value;
+
+            stream >> token;
+            if (token != "name") return;
+
+            while (stream >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+
+            // Values run to the end of the line, as file paths may contain spaces
+            std::getline(stream >> std::ws, value);
+            while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) value.pop_back();
+
+            if (name == "Hash") {
+                const auto megabytes = utils::parse_int<usize>(value);
+                if (!megabytes) return;
+                engine.pool.set_hash(std::clamp<usize>(*megabytes, 1, kMaxHashMB));
+            } else if (name == "Threads") {
+                const auto threads = utils::parse_int<usize>(value);
+                if (!threads) return;
+                engine.pool.set_threads(std::clamp<usize>(*threads, 1, search::kMaxThreads));
+            } else if (name == "MultiPV") {
+                const auto lines = utils::parse_int<usize>(value);
+                if (!lines) return;
+                engine.multiPV = std::clamp<usize>(*lines, 1, kMaxMultiPV);
+            } else if (name == "Ponder") {
+                // Only tells us that the GUI may send `go ponder`, which needs no preparation
+            } else if (name == "EvalFile") {
+                engine.pool.wait();
+                if (value.empty() || value == "<empty>") {
+                    nnue::unload();
+                    std::cout << "info string using the handcrafted evaluation" << std::endl;
+                } else if (nnue::load(value)) {
+                    std::cout << "info string loaded network " << value << std::endl;
+                } else {
+                    std::cout << "info string could not load network " << value << "; keeping the current evaluation" << std::endl;
+                }
+            } else if (name == "UCI_Chess960") {
+                engine.chess960 = value == "true";
+            } else if (name == "Deterministic") {
+                engine.pool.set_deterministic(value == "true");
+            } else {
+                switch (tune::set(name, value)) {
+                    case tune::SetResult::kOk:
+                        break;
+                    case tune::SetResult::kUnknownName:
+                        std::cout << "info string unknown option " << name << std::endl;
+                        break;
+                    case tune::SetResult::kInvalidValue:
+                        std::cout << "info string invalid value for " << name << std::endl;
+                        break;
+                }
+            }
+        }
+
+        // Plays the moves of a `position` command. Returns false, leaving the moves before it played, at an illegal move.
+        [[nodiscard]] bool play_moves(Engine &engine, std::string_view moves) {
+            for (std::string_view token = utils::next_token(moves); !token.empty(); token = utils::next_token(moves)) {
+                const Move move = engine.pos.parse_move(token);
+                if (move == Moves::kNone) {
+                    std::cout << "info string illegal move " << token << std::endl;
+                    return false;
+                }
+                engine.pos.make_move(move);
+            }
+            return true;
+        }
+
+        void handle_position(Engine &engine, std::string_view args) {
+            // GUIs resend the whole game before every move. When the command only appends moves to the previous
+            // one, just those moves are played.
+            const std::string_view previous = engine.lastPosition;
+            if (!previous.empty() && args.starts_with(previous) && args.size() > previous.size() && args[previous.size()] == ' ') {
+                std::string_view appended = args.substr(previous.size());
+                if (previous.find(" moves") != std::string_view::npos || utils::next_token(appended) == "moves") {
+                    engine.lastPosition = play_moves(engine, appended) ? args : std::string_view{};
+                    return;
+                }
+            }
+
+            engine.lastPosition.clear();
+            std::string_view rest = args;
+            const std::string_view token = utils::next_token(rest);
+            std::string_view fen, moves;
+
+            if (token == "startpos") {
+                fen = kStartPosFen;
+                moves = rest;
+            } else if (token == "fen") {
+                rest.remove_prefix(std::min(rest.find_first_not_of(' '), rest.size()));
+                const usize movesStart = rest.find(" moves");
+                fen = rest.substr(0, movesStart);
+                moves = movesStart == std::string_view::npos ? std::string_view{} : rest.substr(movesStart);
+            } else {
+                return;
+            }
+
+            // Whatever follows the position must be the moves
+            if (utils::next_token(moves) != "moves" && !moves.empty()) moves = {};
+
+            const auto pos = Position::from_fen(fen);
+            if (!pos) {
+                std::cout << "info string invalid fen " << fen << std::endl;
+                return;
+            }
+
+            engine.pos = *pos;
+            if (play_moves(engine, moves)) engine.lastPosition = args;
+        }
+
+        void handle_go(Engine &engine, std::istringstream &stream) {
+            search::Limits limits;
+            limits.multiPV = engine.multiPV;
+            limits.chess960 = engine.chess960;
+            std::string token;
+
+            while (stream >> token) {
+                if (token == "perft") {
+                    i32 depth = 1;
+                    stream >> depth;
+                    split_perft(engine.pos, depth, engine.chess960);
+                    return;
+                }
+
+                if (token == "infinite") limits.infinite = true;
+                else if (token == "ponder") limits.ponder = true;
+                else if (token == "depth") stream >> limits.depth;
+                else if (token == "nodes") stream >> limits.nodes;
+                else if (token == "mate") stream >> limits.mate;
+                else if (token == "movetime") stream >> limits.movetime;
+                else if (token == "wtime") stream >> limits.time[Colours::kWhite];
+                else if (token == "btime") stream >> limits.time[Colours::kBlack];
+                else if (token == "winc") stream >> limits.inc[Colours::kWhite];
+                else if (token == "binc") stream >> limits.inc[Colours::kBlack];
+                else if (token == "movestogo") stream >> limits.movestogo;
+            }
+
+            engine.pool.start(engine.pos, limits);
+        }
+    }
+
+    void loop() {
+        Engine engine;
+        std::string line, token;
+
+        while (std::getline(std::cin, line)) {
+            std::istringstream stream{line};
+            token.clear();
+            stream >> token;
+
+            if (token == "quit") break;
+            else if (token == "uci") handle_uci();
+            else if (token == "isready") std::cout << "readyok" << std::endl;
+            else if (token == "ucinewgame") {
+                engine.pool.wait();
+                engine.tt.clear();
+                engine.pool.clear();
+            }
+            else if (token == "setoption") handle_setoption(engine, stream);
+            else if (token == "position") {
+                const auto offset = stream.tellg();
+                handle_position(engine, offset < 0 ? std::string_view{} : std::string_view{line}.substr(static_cast<usize>(offset)));
+            }
+            else if (token == "go") handle_go(engine, stream);
+            else if (token == "stop") engine.pool.stop();
+            else if (token == "ponderhit") engine.pool.ponderhit();
+            else if (token == "bench") {
+                i32 depth = bench::kDefaultDepth;
+                usize threads = 1;
+                stream >> depth >> threads;
+                engine.pool.wait();
+                bench::run(std::clamp(depth, 1, search::kMaxDepth), std::clamp<usize>(threads, 1, search::kMaxThreads));
+            }
+            else if (token == "stats") {
+                engine.pool.wait();
+                stream >> token;
+                if (token == "clear") engine.pool.clear_stats();
+                else engine.pool.stats().print(std::cout);
+            }
+            else if (token == "trace") {
+                engine.pool.wait();
+                std::string prefix;
+                stream >> token >> prefix;
+                if constexpr (!trace::kEnabled) std::cout << "info string tracing is not available; rebuild with `make TRACE=yes`" << std::endl;
+                else if (token == "clear") engine.pool.clear_trace();
+                else if (token == "save" && !prefix.empty()) {
+                    if (!engine.pool.save_trace(prefix)) std::cout << "info string could not write trace files" << std::endl;
+                }
+                else std::cout << "info string usage: trace save <prefix> | trace clear" << std::endl;
+            }
+            else if (token == "tune") {
+                if constexpr (tune::kEnabled) tune::print_spsa(std::cout);
+                else std::cout << "info string no tunable parameters; rebuild with `make TUNE=yes`" << std::endl;
+            }
+            else if (token == "d") std::cout << engine.pos.to_str() << std::endl;
+            else if (token == "eval") std::cout << "Static eval: " << eval::evaluate(engine.pos) << std::endl;
+            else if (!token.empty()) std::cout << "Unknown command: " << token << std::endl;
+        }
+
+        engine.pool.stop();
+        engine.pool.wait();
+    }
+}
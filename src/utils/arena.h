@@ -0,0 +1,105 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+    #include <malloc.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+namespace purebred::utils {
+
+    // A bump allocator over a single aligned block, for state which lives as long as its owner. Objects are
+    // constructed in place and never destroyed individually, so only trivially destructible types are allowed.
+    // Blocks of at least a megabyte are rounded up to whole 2 MiB pages and offered to transparent huge pages.
+    class Arena {
+    public:
+        // The capacity needed to hold one object of each of the given types, whatever the block's alignment
+        template <typename... Ts>
+        [[nodiscard]] static constexpr usize footprint() {
+            return ((sizeof(Ts) + alignof(Ts) - 1) + ... + 0);
+        }
+
+        explicit Arena(usize capacity) {
+            constexpr usize kHugePage = 2 * 1024 * 1024;
+            const usize alignment = capacity >= kHugePage / 2 ? kHugePage : 64;
+            mCapacity = (capacity + alignment - 1) / alignment * alignment;
+
+#ifdef _WIN32
+            mData = static_cast<u8 *>(_aligned_malloc(mCapacity, alignment));
+#else
+            mData = static_cast<u8 *>(std::aligned_alloc(alignment, mCapacity));
+    #ifdef MADV_HUGEPAGE
+            if (mData && alignment == kHugePage) madvise(mData, mCapacity, MADV_HUGEPAGE);
+    #endif
+#endif
+
+            if (!mData) {
+                std::fprintf(stderr, "Failed to allocate %zu bytes\n", mCapacity);
+                std::abort();
+            }
+        }
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena() {
+#ifdef _WIN32
+            _aligned_free(mData);
+#else
+            std::free(mData);
+#endif
+        }
+
+        // Value-initialises a T in the arena. The arena must have room for it.
+        template <typename T, typename... Args>
+        [[nodiscard]] T &make(Args &&...args) {
+            static_assert(std::is_trivially_destructible_v<T>);
+
+            const usize offset = (mUsed + alignof(T) - 1) / alignof(T) * alignof(T);
+            assert(offset + sizeof(T) <= mCapacity);
+            mUsed = offset + sizeof(T);
+
+            return *new (mData + offset) T(std::forward<Args>(args)...);
+        }
+
+        [[nodiscard]] usize used() const {
+            return mUsed;
+        }
+
+        [[nodiscard]] usize capacity() const {
+            return mCapacity;
+        }
+
+    private:
+        u8 *mData = nullptr;
+        usize mCapacity = 0;
+        usize mUsed = 0;
+    };
+}
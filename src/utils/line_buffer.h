@@ -0,0 +1,82 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "mdarray.h"
+#include "../types.h"
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstdio>
+#include <string_view>
+
+namespace purebred::utils {
+
+    // One line of output, formatted straight into a fixed buffer and written to stdout with a single call, so
+    // that frequent reports neither allocate nor take the stream lock more than once. Anything beyond the
+    // capacity is dropped.
+    class LineBuffer {
+    public:
+        static constexpr usize kCapacity = 4096;
+
+        LineBuffer &operator<<(std::string_view str) {
+            const usize count = std::min(str.size(), this->remaining());
+            std::copy_n(str.data(), count, mData.data() + mSize);
+            mSize += count;
+            return *this;
+        }
+
+        LineBuffer &operator<<(char c) {
+            if (this->remaining()) mData[mSize++] = c;
+            return *this;
+        }
+
+        template <std::integral T>
+        LineBuffer &operator<<(T value) {
+            const auto [end, error] = std::to_chars(mData.data() + mSize, mData.data() + kCapacity - 1, value);
+            if (error == std::errc{}) mSize = static_cast<usize>(end - mData.data());
+            return *this;
+        }
+
+        // Lets `write` fill in up to maxSize characters directly; it returns the end of what it wrote
+        template <typename Writer>
+        LineBuffer &write(usize maxSize, Writer writer) {
+            if (maxSize <= this->remaining()) mSize = static_cast<usize>(writer(mData.data() + mSize) - mData.data());
+            return *this;
+        }
+
+        // Ends the line, writes it out and starts a new one
+        void flush() {
+            mData[mSize++] = '\n';
+            std::fwrite(mData.data(), 1, mSize, stdout);
+            std::fflush(stdout);
+            mSize = 0;
+        }
+
+    private:
+        MDArray<char, kCapacity> mData;
+        usize mSize = 0;
+
+        // Space left for text, keeping one character for the newline
+        [[nodiscard]] usize remaining() const {
+            return kCapacity - 1 - mSize;
+        }
+    };
+}
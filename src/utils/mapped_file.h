@@ -0,0 +1,138 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "../types.h"
+
+#include <algorithm>
+#include <string>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace purebred::utils {
+
+    // A read-only memory mapping of a whole file, so that huge inputs can be scanned without copying them.
+    class MappedFile {
+    public:
+        [[nodiscard]] MappedFile() = default;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile() {
+            this->close();
+        }
+
+        [[nodiscard]] bool open(const std::string &path) {
+            this->close();
+
+#ifdef _WIN32
+            mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (mFile == INVALID_HANDLE_VALUE) return false;
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(mFile, &size)) return false;
+            mSize = static_cast<usize>(size.QuadPart);
+            if (mSize == 0) return true;
+
+            mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mMapping) return false;
+
+            mData = static_cast<const u8 *>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+            return mData != nullptr;
+#else
+            mFd = ::open(path.c_str(), O_RDONLY);
+            if (mFd < 0) return false;
+
+            struct stat st;
+            if (fstat(mFd, &st) != 0) return false;
+            mSize = static_cast<usize>(st.st_size);
+            if (mSize == 0) return true;
+
+            void *data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFd, 0);
+            if (data == MAP_FAILED) return false;
+
+            // No access pattern is advised for the whole file: some readers scan it front to back, but dataprep
+            // visits chunks in shuffled order, where sequential read-ahead would fetch pages it does not use next.
+            // Readers jumping around ask for the range they are about to read with prefetch() instead.
+            mData = static_cast<const u8 *>(data);
+            return true;
+#endif
+        }
+
+        void close() {
+#ifdef _WIN32
+            if (mData) UnmapViewOfFile(mData);
+            if (mMapping) CloseHandle(mMapping);
+            if (mFile != INVALID_HANDLE_VALUE) CloseHandle(mFile);
+            mMapping = nullptr;
+            mFile = INVALID_HANDLE_VALUE;
+#else
+            if (mData) munmap(const_cast<u8 *>(mData), mSize);
+            if (mFd >= 0) ::close(mFd);
+            mFd = -1;
+#endif
+            mData = nullptr;
+            mSize = 0;
+        }
+
+        [[nodiscard]] const u8 *data() const {
+            return mData;
+        }
+
+        [[nodiscard]] usize size() const {
+            return mSize;
+        }
+
+        // Asks the kernel to start reading the given byte range in, ahead of it being scanned
+        void prefetch([[maybe_unused]] usize offset, [[maybe_unused]] usize length) const {
+#ifndef _WIN32
+            if (!mData || offset >= mSize) return;
+
+            // madvise needs a page-aligned start
+            const usize page = static_cast<usize>(sysconf(_SC_PAGESIZE));
+            const usize begin = offset / page * page;
+            const usize end = std::min(offset + length, mSize);
+            madvise(const_cast<u8 *>(mData + begin), end - begin, MADV_WILLNEED);
+#endif
+        }
+
+    private:
+        const u8 *mData = nullptr;
+        usize mSize = 0;
+
+#ifdef _WIN32
+        HANDLE mFile = INVALID_HANDLE_VALUE;
+        HANDLE mMapping = nullptr;
+#else
+        i32 mFd = -1;
+#endif
+    };
+}
@@ -119,11 +119,11 @@ namespace purebred::utils {
             return mData.back();
         }
 
-        [[nodiscard]] pointer data() {
+        [[nodiscard]] constexpr pointer data() {
             return mData.data();
         }
 
-        [[nodiscard]] const_pointer data() const {
+        [[nodiscard]] constexpr const_pointer data() const {
             return mData.data();
         }
 
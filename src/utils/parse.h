@@ -0,0 +1,56 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "../types.h"
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <string_view>
+
+namespace purebred::utils {
+
+    // Parses an integer, failing (rather than throwing, as we build without exceptions) on malformed input.
+    template <typename T>
+    [[nodiscard]] std::optional<T> parse_int(std::string_view str) {
+        T value{};
+        const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+        if (ec != std::errc{} || ptr != str.data() + str.size()) return std::nullopt;
+        return value;
+    }
+
+    // Splits the next whitespace-separated token off the front of str. Returns an empty token once str runs out.
+    [[nodiscard]] constexpr std::string_view next_token(std::string_view &str) {
+        constexpr std::string_view kWhitespace = " \t\r\n";
+
+        const usize start = str.find_first_not_of(kWhitespace);
+        if (start == std::string_view::npos) {
+            str = {};
+            return {};
+        }
+        str.remove_prefix(start);
+
+        const usize end = std::min(str.find_first_of(kWhitespace), str.size());
+        const std::string_view token = str.substr(0, end);
+        str.remove_prefix(end);
+        return token;
+    }
+}
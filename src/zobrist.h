@@ -0,0 +1,79 @@
+/*
+ * Purebred, a UCI chess engine
+ * Copyright (C) 2025 cj5716
+ *
+ * Purebred is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Purebred is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Purebred. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "core.h"
+#include "types.h"
+#include "utils/mdarray.h"
+#include "utils/prng.h"
+
+// Zobrist keys are generated at compile time from a fixed seed, so hashes are stable across builds and runs.
+namespace purebred::zobrist {
+
+    constexpr usize kNumCastlingStates = 16;
+
+    struct Keys {
+        utils::MDArray<u64, Piece::kNumTypes, Square::kNumTypes> pieceSquare;
+        utils::MDArray<u64, kNumCastlingStates> castling;
+        utils::MDArray<u64, Files::kNum> enPassant;
+        u64 stm;
+    };
+
+    constexpr Keys kKeys = []() {
+        Keys keys{};
+        utils::PRNG prng{U64C(0x5075726562726564)};
+
+        for (usize pc = 0; pc < Piece::kNumTypes; ++pc) {
+            for (usize sq = 0; sq < Square::kNumTypes; ++sq) keys.pieceSquare[pc][sq] = prng.next();
+        }
+
+        // Castling keys are built from one key per right, so that the key of a combination of rights
+        // is the XOR of the keys of the individual rights.
+        utils::MDArray<u64, 4> rightKeys{};
+        for (usize i = 0; i < 4; ++i) rightKeys[i] = prng.next();
+        for (usize mask = 0; mask < kNumCastlingStates; ++mask) {
+            keys.castling[mask] = 0;
+            for (usize i = 0; i < 4; ++i) {
+                if (mask & (1 << i)) keys.castling[mask] ^= rightKeys[i];
+            }
+        }
+
+        for (usize file = 0; file < Files::kNum; ++file) keys.enPassant[file] = prng.next();
+        keys.stm = prng.next();
+
+        return keys;
+    }();
+
+    [[nodiscard]] constexpr u64 piece_square(Piece pc, Square sq) {
+        return kKeys.pieceSquare[pc][sq];
+    }
+
+    [[nodiscard]] constexpr u64 castling(usize mask) {
+        return kKeys.castling[mask];
+    }
+
+    [[nodiscard]] constexpr u64 en_passant(Square sq) {
+        return kKeys.enPassant[sq.file()];
+    }
+
+    [[nodiscard]] constexpr u64 stm() {
+        return kKeys.stm;
+    }
+}